@@ -23,9 +23,28 @@
 #include "tree/bst.hpp"
 #include "tree/leftist.hpp"
 #include "tree/avl_tree.hpp"
+#include "tree/rb_tree.hpp"
+#include "tree/splay_tree.hpp"
+#include "tree/segment_tree.hpp"
+#include "tree/fenwick_tree.hpp"
+#include "tree/art_tree.hpp"
+#include "tree/suffix_array.hpp"
+#include "tree/compact_avl_tree.hpp"
+#include "tree/eytzinger_tree.hpp"
+#include "tree/bplus_tree.hpp"
+#include "tree/disk_btree.hpp"
 
 /* Hash */
+#include "hash/swiss_table.hpp"
+#include "hash/chained_table.hpp"
+#include "hash/perfect_hash.hpp"
+#include "hash/concurrent_map.hpp"
+#include "hash/cuckoo_table.hpp"
+#include "hash/robin_hood_table.hpp"
 
 /* Others */
 #include "others/disjoint_set.hpp"
+#include "others/concurrent_disjoint_set.hpp"
 #include "others/bloom_filter.hpp"
+#include "others/node_pool.hpp"
+#include "others/mapped_file.hpp"
@@ -0,0 +1,456 @@
+#pragma once
+
+#include "hash_util.hpp"
+#include "../others/node_pool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cassert>
+#include <stdexcept>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <utility>
+#include <bit>
+#include <type_traits>
+#include <algorithm>
+
+/* Declaration */
+namespace ds_imp {
+
+template <typename K, typename V>
+struct Chain_Node {
+    Chain_Node<K, V> *next;
+    size_t hash;          // kept so moving a node never calls the hash function again
+    K key;
+    V value;
+
+    Chain_Node(size_t hash, const K &key, const V &value, Chain_Node<K, V> *next = nullptr);
+};
+
+/*
+ * Separate chaining with incremental rehash: growing allocates a table twice as large, and each
+ * later insert or erase splits at most REHASH_BUCKETS buckets of the old table into it, so no
+ * single operation pays for the whole table. Old bucket b splits into new buckets b and b + B;
+ * until it does, its keys (and new keys hashing to it) stay in the old table, so every key has
+ * exactly one bucket and a lookup probes one chain.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class Chained_Table {
+
+    using Node = Chain_Node<K, V>;
+
+    struct Bucket_Array {
+        Node **heads = nullptr;
+        size_t num_buckets = 0;   // a power of two, or zero when unused
+    };
+
+    public:
+        Chained_Table(size_t buckets = 0, float max_load = DEFAULT_MAX_LOAD);
+        ~Chained_Table();
+
+        Chained_Table(const Chained_Table &other) = delete;
+        Chained_Table& operator=(const Chained_Table &other) = delete;
+        Chained_Table(Chained_Table &&other) noexcept;
+        Chained_Table& operator=(Chained_Table &&other) noexcept;
+
+        void insert(const K &key, const V &value);
+        void insert_or_update(const K &key, const V &value);
+        bool erase(const K &key);
+        V* find(const K &key);
+        const V* find(const K &key) const;
+        inline bool contains(const K &key) const;
+        void clear();
+        template <typename Func>
+        void for_each(Func fn) const;
+        void show(std::ostream &os) const;
+        inline float load_factor() const;
+        inline float max_load_factor() const;
+        void max_load_factor(float max_load);
+        inline bool is_rehashing() const;
+        inline bool empty() const;
+        inline size_t size() const;
+        inline size_t bucket_count() const;
+
+        static constexpr float  DEFAULT_MAX_LOAD = 1.0f;
+        static constexpr size_t MIN_BUCKETS      = 16;
+        static constexpr size_t REHASH_BUCKETS   = 8;    // buckets moved per step
+        static constexpr size_t REHASH_VISITS    = 64;   // buckets looked at per step, empty or not
+
+    private:
+        Bucket_Array tables[2];       // tables[1] is the target of a running rehash
+        size_t rehash_pos;            // tables[0] buckets below it are split, and only the matching
+                                      // tables[1] buckets are initialized
+        size_t num_elements;
+        float max_load;
+        Node_Pool<Node> pool;
+        Hash hasher;
+
+        inline size_t hash_of(const K &key) const;
+        inline Node*& bucket_of(size_t h) const;
+        template <typename Func>
+        void for_each_head(Func fn) const;
+        Node* find_node(const K &key, size_t h) const;
+        void link_new(size_t h, const K &key, const V &value);
+        void rehash_step();
+        void finish_rehash();
+        void start_rehash(size_t buckets);
+        void destroy_nodes();
+
+        static Node** allocate_heads(size_t buckets, bool zeroed);
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+/* Chain_Node */
+template <typename K, typename V>
+Chain_Node<K, V>::Chain_Node(size_t hash, const K &key, const V &value, Chain_Node<K, V> *next)
+    : next(next),
+      hash(hash),
+      key(key),
+      value(value) {}
+
+/* Chained_Table */
+template <typename K, typename V, typename Hash>
+Chained_Table<K, V, Hash>::Chained_Table(size_t buckets, float max_load)
+    : rehash_pos(0),
+      num_elements(0),
+      max_load(DEFAULT_MAX_LOAD) {
+
+    max_load_factor(max_load);
+    if(buckets > 0) {
+        tables[0].num_buckets = std::bit_ceil(std::max(buckets, MIN_BUCKETS));
+        tables[0].heads = allocate_heads(tables[0].num_buckets, true);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+Chained_Table<K, V, Hash>::~Chained_Table() {
+
+    destroy_nodes();
+    std::free(tables[0].heads);
+    std::free(tables[1].heads);
+}
+
+template <typename K, typename V, typename Hash>
+Chained_Table<K, V, Hash>::Chained_Table(Chained_Table &&other) noexcept
+    : rehash_pos(std::exchange(other.rehash_pos, 0)),
+      num_elements(std::exchange(other.num_elements, 0)),
+      max_load(other.max_load),
+      pool(std::move(other.pool)),
+      hasher(std::move(other.hasher)) {
+
+    tables[0] = std::exchange(other.tables[0], Bucket_Array());
+    tables[1] = std::exchange(other.tables[1], Bucket_Array());
+}
+
+template <typename K, typename V, typename Hash>
+Chained_Table<K, V, Hash>& Chained_Table<K, V, Hash>::operator=(Chained_Table &&other) noexcept {
+
+    if(this == &other) return *this;
+
+    destroy_nodes();
+    std::free(tables[0].heads);
+    std::free(tables[1].heads);
+
+    tables[0] = std::exchange(other.tables[0], Bucket_Array());
+    tables[1] = std::exchange(other.tables[1], Bucket_Array());
+    rehash_pos = std::exchange(other.rehash_pos, 0);
+    num_elements = std::exchange(other.num_elements, 0);
+    max_load = other.max_load;
+    pool = std::move(other.pool);
+    hasher = std::move(other.hasher);
+    return *this;
+}
+
+template <typename K, typename V, typename Hash>
+void Chained_Table<K, V, Hash>::insert(const K &key, const V &value) {
+
+    size_t h = hash_of(key);
+    if(find_node(key, h) != nullptr) {
+        throw std::runtime_error("The key has been in the Chained_Table");
+    }
+    link_new(h, key, value);
+}
+
+template <typename K, typename V, typename Hash>
+void Chained_Table<K, V, Hash>::insert_or_update(const K &key, const V &value) {
+
+    size_t h = hash_of(key);
+    Node *node = find_node(key, h);
+    if(node != nullptr) {
+        node->value = value;
+        return;
+    }
+    link_new(h, key, value);
+}
+
+template <typename K, typename V, typename Hash>
+bool Chained_Table<K, V, Hash>::erase(const K &key) {
+
+    if(is_rehashing())
+        rehash_step();
+
+    if(tables[0].num_buckets == 0)
+        return false;
+
+    size_t h = hash_of(key);
+    for(Node **link = &bucket_of(h); *link != nullptr; link = &(*link)->next) {
+        Node *node = *link;
+        if(node->hash == h && node->key == key) {
+            *link = node->next;
+            pool.destroy(node);
+            num_elements --;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename K, typename V, typename Hash>
+V* Chained_Table<K, V, Hash>::find(const K &key) {
+
+    Node *node = find_node(key, hash_of(key));
+    return (node == nullptr) ? (nullptr) : (&node->value);
+}
+
+template <typename K, typename V, typename Hash>
+const V* Chained_Table<K, V, Hash>::find(const K &key) const {
+
+    Node *node = find_node(key, hash_of(key));
+    return (node == nullptr) ? (nullptr) : (&node->value);
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Chained_Table<K, V, Hash>::contains(const K &key) const {
+    return find_node(key, hash_of(key)) != nullptr;
+}
+
+template <typename K, typename V, typename Hash>
+void Chained_Table<K, V, Hash>::clear() {
+
+    // trivial nodes skip the chain walk: the pool drops all of its blocks at once
+    destroy_nodes();
+    pool.release_all();
+
+    // a running rehash is dropped; the old table is the fully initialized one
+    std::free(std::exchange(tables[1], Bucket_Array()).heads);
+    rehash_pos = 0;
+    std::fill(tables[0].heads, tables[0].heads + tables[0].num_buckets, nullptr);
+    num_elements = 0;
+}
+
+template <typename K, typename V, typename Hash>
+template <typename Func>
+void Chained_Table<K, V, Hash>::for_each(Func fn) const {
+
+    for_each_head([&fn](Node *&head) {
+        for(Node *node = head; node != nullptr; node = node->next)
+            fn(node->key, node->value);
+    });
+}
+
+template <typename K, typename V, typename Hash>
+void Chained_Table<K, V, Hash>::show(std::ostream &os) const {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Buckets: " << std::setw(4) << bucket_count();
+    if(is_rehashing())
+        os << " (rehashing into " << tables[1].num_buckets << ", at " << rehash_pos << ")";
+    os << std::endl;
+
+    for_each([&os](const K &key, const V &value) {
+        os << key << ": " << value << ", ";
+    });
+    os << std::endl;
+}
+
+template <typename K, typename V, typename Hash>
+inline float Chained_Table<K, V, Hash>::load_factor() const {
+    return (bucket_count() == 0) ? (0.0f) : (static_cast<float>(num_elements) / bucket_count());
+}
+
+template <typename K, typename V, typename Hash>
+inline float Chained_Table<K, V, Hash>::max_load_factor() const {
+    return max_load;
+}
+
+template <typename K, typename V, typename Hash>
+void Chained_Table<K, V, Hash>::max_load_factor(float max_load) {
+
+    if(!(max_load > 0.0f)) {
+        throw std::out_of_range("The max load is out of range");
+    }
+    this->max_load = max_load;
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Chained_Table<K, V, Hash>::is_rehashing() const {
+    return tables[1].num_buckets != 0;
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Chained_Table<K, V, Hash>::empty() const {
+    return (size() == 0);
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Chained_Table<K, V, Hash>::size() const {
+    return num_elements;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Chained_Table<K, V, Hash>::bucket_count() const {
+    // the table new keys go to
+    return (is_rehashing()) ? (tables[1].num_buckets) : (tables[0].num_buckets);
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Chained_Table<K, V, Hash>::hash_of(const K &key) const {
+    return hash_mix(hasher(key));
+}
+
+template <typename K, typename V, typename Hash>
+inline Chained_Table<K, V, Hash>::Node*& Chained_Table<K, V, Hash>::bucket_of(size_t h) const {
+
+    // the one bucket that holds h: the old one until it has been split
+    size_t b = h & (tables[0].num_buckets - 1);
+    if(is_rehashing() && b < rehash_pos)
+        return tables[1].heads[h & (tables[1].num_buckets - 1)];
+    return tables[0].heads[b];
+}
+
+template <typename K, typename V, typename Hash>
+template <typename Func>
+void Chained_Table<K, V, Hash>::for_each_head(Func fn) const {
+
+    // every initialized bucket that can hold a key
+    const Bucket_Array &from = tables[0], &to = tables[1];
+    if(is_rehashing()) {
+        for(size_t b = 0; b < rehash_pos; ++b) {
+            fn(to.heads[b]);
+            fn(to.heads[b + from.num_buckets]);
+        }
+    }
+    for(size_t b = rehash_pos; b < from.num_buckets; ++b)
+        fn(from.heads[b]);
+}
+
+template <typename K, typename V, typename Hash>
+Chained_Table<K, V, Hash>::Node* Chained_Table<K, V, Hash>::find_node(const K &key, size_t h) const {
+
+    if(tables[0].num_buckets == 0)
+        return nullptr;
+
+    for(Node *node = bucket_of(h); node != nullptr; node = node->next) {
+        if(node->hash == h && node->key == key)
+            return node;
+    }
+    return nullptr;
+}
+
+template <typename K, typename V, typename Hash>
+void Chained_Table<K, V, Hash>::link_new(size_t h, const K &key, const V &value) {
+
+    if(is_rehashing())
+        rehash_step();
+
+    if(tables[0].num_buckets == 0) {
+        tables[0].num_buckets = MIN_BUCKETS;
+        tables[0].heads = allocate_heads(MIN_BUCKETS, true);
+    }
+    else if(num_elements + 1 > static_cast<double>(bucket_count()) * max_load) {
+        // a rehash still running here means max_load is below 1 / REHASH_BUCKETS;
+        // finish it so the two-table invariant holds
+        if(is_rehashing())
+            finish_rehash();
+        start_rehash(2 * tables[0].num_buckets);
+    }
+
+    Node *&head = bucket_of(h);
+    head = pool.create(h, key, value, head);
+    num_elements ++;
+}
+
+template <typename K, typename V, typename Hash>
+void Chained_Table<K, V, Hash>::rehash_step() {
+
+    // split up to REHASH_BUCKETS non-empty buckets, looking at no more than REHASH_VISITS in all
+    Bucket_Array &from = tables[0], &to = tables[1];
+    size_t moved = 0, end = std::min(from.num_buckets, rehash_pos + REHASH_VISITS);
+
+    for(; rehash_pos < end && moved < REHASH_BUCKETS; ++rehash_pos) {
+        Node *&low = to.heads[rehash_pos], *&high = to.heads[rehash_pos + from.num_buckets];
+        low = high = nullptr;
+
+        Node *node = std::exchange(from.heads[rehash_pos], nullptr);
+        if(node == nullptr)
+            continue;
+
+        while(node != nullptr) {
+            Node *next = node->next;
+            Node *&head = (node->hash & from.num_buckets) ? (high) : (low);
+            node->next = head;
+            head = node;
+            node = next;
+        }
+        moved ++;
+    }
+
+    if(rehash_pos == from.num_buckets) {
+        std::free(from.heads);
+        tables[0] = std::exchange(tables[1], Bucket_Array());
+        rehash_pos = 0;
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void Chained_Table<K, V, Hash>::finish_rehash() {
+
+    while(is_rehashing())
+        rehash_step();
+}
+
+template <typename K, typename V, typename Hash>
+void Chained_Table<K, V, Hash>::start_rehash(size_t buckets) {
+
+    tables[1].heads = allocate_heads(buckets, false);
+    tables[1].num_buckets = buckets;
+    rehash_pos = 0;
+}
+
+template <typename K, typename V, typename Hash>
+void Chained_Table<K, V, Hash>::destroy_nodes() {
+
+    if constexpr (std::is_trivially_destructible_v<Node>) {
+        return;
+    }
+    else {
+        for_each_head([this](Node *&head) {
+            for(Node *node = std::exchange(head, nullptr); node != nullptr; ) {
+                Node *next = node->next;
+                pool.destroy(node);
+                node = next;
+            }
+        });
+    }
+}
+
+template <typename K, typename V, typename Hash>
+Chained_Table<K, V, Hash>::Node** Chained_Table<K, V, Hash>::allocate_heads(size_t buckets, bool zeroed) {
+
+    // a rehash target is left uninitialized: rehash_step writes each bucket pair as it splits,
+    // so starting a rehash never touches the whole new table
+    void *raw = (zeroed) ? (std::calloc(buckets, sizeof(Node*))) : (std::malloc(buckets * sizeof(Node*)));
+    Node **heads = static_cast<Node**>(raw);
+    if(heads == nullptr) {
+        throw std::bad_alloc();
+    }
+    return heads;
+}
+
+}
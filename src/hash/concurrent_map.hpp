@@ -0,0 +1,576 @@
+#pragma once
+
+#include "hash_util.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <stdexcept>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <memory>
+#include <optional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <bit>
+#include <type_traits>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Declaration */
+namespace ds_imp {
+
+/*
+ * Hash map shared between threads. Keys are spread over power-of-two shards by the top hash bits;
+ * each shard is a linear-probing table with backward-shift deletion, one writer mutex and a
+ * sequence counter that writers make odd while they change it. As in Swiss_Table, every slot has a
+ * control byte holding 7 hash bits, kept apart from the entries, so a probe scans a small array
+ * that stays in cache and reads one entry per likely match. When K is a scalar and V is trivially
+ * copyable, entries are kept as 64-bit words that every access loads and stores with relaxed
+ * atomics, and find() reads without writing any shared cache line: it copies the entry out and
+ * retries if the counter moved, falling back to the mutex after OPTIMISTIC_TRIES. A torn copy is
+ * harmless there, since the key is only compared with the built-in == and the value is only used
+ * once the counter check passes. Other types take the mutex. A grown shard keeps its old arrays
+ * until the map is destroyed, so an optimistic reader never touches freed memory; they add up to
+ * less than the live arrays.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class Concurrent_Map {
+
+    static constexpr bool WORD_SLOTS = std::is_scalar_v<K> && std::is_trivially_copyable_v<V>;
+
+    struct Byte_Slot {
+        alignas(K) std::byte key[sizeof(K)];
+        alignas(V) std::byte value[sizeof(V)];
+    };
+
+    struct Word_Slot {
+        uint64_t key[(sizeof(K) + 7) / 8];
+        uint64_t value[(sizeof(V) + 7) / 8];
+    };
+
+    using Slot = std::conditional_t<WORD_SLOTS, Word_Slot, Byte_Slot>;
+
+    struct Slot_Array {
+        size_t capacity;
+        Slot_Array *retired;                     // the array this one replaced
+        Slot *slots;                             // capacity control bytes follow the header, then the slots
+    };
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<Slot_Array*> array{nullptr};
+        std::atomic<size_t> num_elements{0};     // written under writer, read by size()
+        std::mutex writer;
+    };
+
+    public:
+        Concurrent_Map(size_t shards = DEFAULT_SHARDS);
+        ~Concurrent_Map();
+
+        Concurrent_Map(const Concurrent_Map &other) = delete;
+        Concurrent_Map& operator=(const Concurrent_Map &other) = delete;
+
+        bool insert_or_update(const K &key, const V &value);
+        bool erase(const K &key);
+        std::optional<V> find(const K &key) const;
+        inline bool contains(const K &key) const;
+        void clear();
+        template <typename Func>
+        void for_each(Func fn) const;
+        void show(std::ostream &os) const;
+        inline bool empty() const;
+        size_t size() const;
+        inline size_t shard_count() const;
+
+        static constexpr size_t DEFAULT_SHARDS   = 64;
+        static constexpr size_t MIN_CAPACITY     = 16;
+        static constexpr size_t OPTIMISTIC_TRIES = 8;
+        static constexpr bool   OPTIMISTIC       = WORD_SLOTS;  // find() may read without the mutex
+
+    private:
+        std::unique_ptr<Shard[]> shards;
+        size_t num_shards;
+        unsigned shard_shift;
+        Hash hasher;
+
+        static constexpr int8_t CTRL_EMPTY  = -128;       // a full slot holds the low 7 hash bits
+        static constexpr size_t NPOS        = SIZE_MAX;
+        static constexpr size_t ARRAY_ALIGN = std::max(alignof(Slot_Array), alignof(Slot));
+        static constexpr size_t CTRL_OFFSET = sizeof(Slot_Array);
+
+        inline uint64_t hash_of(const K &key) const;
+        inline Shard& shard_of(uint64_t h) const;
+        std::optional<V> find_locked(Shard &shard, const K &key, uint64_t h) const;
+        void grow(Shard &shard);
+
+        static inline void begin_write(Shard &shard);
+        static inline void end_write(Shard &shard);
+        static inline std::atomic<int8_t>* ctrl_of(Slot_Array *array);
+        static inline size_t home_of(uint64_t h, size_t mask);
+        static inline decltype(auto) key_of(Slot &slot);
+        static inline decltype(auto) value_of(Slot &slot);
+        static inline void store_entry(Slot &slot, const K &key, const V &value);
+        static inline void store_value(Slot &slot, const V &value);
+        static inline void move_entry(Slot &to, Slot &from);
+        static inline void destroy_entry(Slot &slot);
+        template <typename T, size_t N>
+        static inline T load_words(uint64_t (&words)[N]);
+        template <typename T, size_t N>
+        static inline void store_words(uint64_t (&words)[N], const T &object);
+        static size_t probe(Slot_Array *array, const K &key, uint64_t h);
+        static size_t slots_offset(size_t capacity);
+        static Slot_Array* allocate_array(size_t capacity);
+        static void destroy_array(Slot_Array *array, bool live);
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+template <typename K, typename V, typename Hash>
+Concurrent_Map<K, V, Hash>::Concurrent_Map(size_t shards)
+    : num_shards(std::bit_ceil(std::max<size_t>(shards, 1))),
+      shard_shift(64 - std::countr_zero(num_shards)) {
+
+    this->shards = std::make_unique<Shard[]>(num_shards);
+}
+
+template <typename K, typename V, typename Hash>
+Concurrent_Map<K, V, Hash>::~Concurrent_Map() {
+
+    for(size_t s = 0; s < num_shards; ++s) {
+        Slot_Array *array = shards[s].array.load(std::memory_order_relaxed);
+        for(bool live = true; array != nullptr; live = false) {
+            Slot_Array *retired = array->retired;
+            destroy_array(array, live);
+            array = retired;
+        }
+    }
+}
+
+template <typename K, typename V, typename Hash>
+bool Concurrent_Map<K, V, Hash>::insert_or_update(const K &key, const V &value) {
+
+    // true when the key was not in the map
+    uint64_t h = hash_of(key);
+    Shard &shard = shard_of(h);
+    std::lock_guard<std::mutex> guard(shard.writer);
+
+    size_t n = shard.num_elements.load(std::memory_order_relaxed);
+    Slot_Array *array = shard.array.load(std::memory_order_relaxed);
+    size_t i = (array == nullptr) ? (NPOS) : (probe(array, key, h));
+    bool inserted = (i == NPOS || ctrl_of(array)[i].load(std::memory_order_relaxed) == CTRL_EMPTY);
+
+    // linear probing keeps short runs up to a load of 3/4
+    if(inserted && (array == nullptr || 4 * (n + 1) > 3 * array->capacity)) {
+        grow(shard);
+        array = shard.array.load(std::memory_order_relaxed);
+        i = probe(array, key, h);
+    }
+
+    Slot &slot = array->slots[i];
+    begin_write(shard);
+    if(inserted) {
+        store_entry(slot, key, value);
+        ctrl_of(array)[i].store(static_cast<int8_t>(h & 0x7F), std::memory_order_relaxed);
+        shard.num_elements.store(n + 1, std::memory_order_relaxed);
+    }
+    else {
+        store_value(slot, value);
+    }
+    end_write(shard);
+    return inserted;
+}
+
+template <typename K, typename V, typename Hash>
+bool Concurrent_Map<K, V, Hash>::erase(const K &key) {
+
+    uint64_t h = hash_of(key);
+    Shard &shard = shard_of(h);
+    std::lock_guard<std::mutex> guard(shard.writer);
+
+    Slot_Array *array = shard.array.load(std::memory_order_relaxed);
+    if(array == nullptr)
+        return false;
+
+    size_t i = probe(array, key, h);
+    std::atomic<int8_t> *ctrl = ctrl_of(array);
+    Slot *slots = array->slots;
+    if(ctrl[i].load(std::memory_order_relaxed) == CTRL_EMPTY)
+        return false;
+
+    // backward shift: each later entry of the run moves into the hole unless
+    // its home lies cyclically in (hole, entry], so no tombstone is left behind;
+    // the control byte keeps only 7 hash bits, so the home comes from rehashing the key
+    begin_write(shard);
+    size_t mask = array->capacity - 1;
+    destroy_entry(slots[i]);
+
+    for(size_t j = (i + 1) & mask; ; j = (j + 1) & mask) {
+        int8_t c = ctrl[j].load(std::memory_order_relaxed);
+        if(c == CTRL_EMPTY)
+            break;
+
+        size_t home = home_of(hash_of(key_of(slots[j])), mask);
+        if(((j - home) & mask) >= ((j - i) & mask)) {
+            move_entry(slots[i], slots[j]);
+            ctrl[i].store(c, std::memory_order_relaxed);
+            i = j;
+        }
+    }
+    ctrl[i].store(CTRL_EMPTY, std::memory_order_relaxed);
+    shard.num_elements.store(shard.num_elements.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    end_write(shard);
+    return true;
+}
+
+template <typename K, typename V, typename Hash>
+std::optional<V> Concurrent_Map<K, V, Hash>::find(const K &key) const {
+
+    uint64_t h = hash_of(key);
+    int8_t h2 = static_cast<int8_t>(h & 0x7F);
+    Shard &shard = shard_of(h);
+
+    if constexpr (OPTIMISTIC) {
+        for(size_t attempt = 0; attempt < OPTIMISTIC_TRIES; ++attempt) {
+            uint64_t before = shard.seq.load(std::memory_order_acquire);
+            if(before & 1) {
+#if defined(__SSE2__)
+                _mm_pause();
+#else
+                std::this_thread::yield();
+#endif
+                continue;
+            }
+
+            // copies only: anything read here may be torn until the counter check passes
+            std::optional<V> value;
+
+            Slot_Array *array = shard.array.load(std::memory_order_acquire);
+            if(array != nullptr) {
+                std::atomic<int8_t> *ctrl = ctrl_of(array);
+                Slot *slots = array->slots;
+                size_t mask = array->capacity - 1;
+
+                for(size_t i = home_of(h, mask), step = 0; step <= mask; i = (i + 1) & mask, ++step) {
+                    int8_t c = ctrl[i].load(std::memory_order_relaxed);
+                    if(c == CTRL_EMPTY)
+                        break;
+                    if(c != h2)
+                        continue;
+
+                    if(key_of(slots[i]) == key) {
+                        value.emplace(value_of(slots[i]));
+                        break;
+                    }
+                }
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(shard.seq.load(std::memory_order_relaxed) == before)
+                return value;
+        }
+    }
+
+    return find_locked(shard, key, h);
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Concurrent_Map<K, V, Hash>::contains(const K &key) const {
+    return find(key).has_value();
+}
+
+template <typename K, typename V, typename Hash>
+void Concurrent_Map<K, V, Hash>::clear() {
+
+    for(size_t s = 0; s < num_shards; ++s) {
+        Shard &shard = shards[s];
+        std::lock_guard<std::mutex> guard(shard.writer);
+
+        Slot_Array *array = shard.array.load(std::memory_order_relaxed);
+        if(array == nullptr)
+            continue;
+
+        begin_write(shard);
+        std::atomic<int8_t> *ctrl = ctrl_of(array);
+        for(size_t i = 0; i < array->capacity; ++i) {
+            if(ctrl[i].load(std::memory_order_relaxed) == CTRL_EMPTY)
+                continue;
+            destroy_entry(array->slots[i]);
+            ctrl[i].store(CTRL_EMPTY, std::memory_order_relaxed);
+        }
+        shard.num_elements.store(0, std::memory_order_relaxed);
+        end_write(shard);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+template <typename Func>
+void Concurrent_Map<K, V, Hash>::for_each(Func fn) const {
+
+    // each shard is visited under its own lock, so the walk is not one atomic snapshot
+    for(size_t s = 0; s < num_shards; ++s) {
+        Shard &shard = shards[s];
+        std::lock_guard<std::mutex> guard(shard.writer);
+
+        Slot_Array *array = shard.array.load(std::memory_order_relaxed);
+        if(array == nullptr)
+            continue;
+
+        std::atomic<int8_t> *ctrl = ctrl_of(array);
+        for(size_t i = 0; i < array->capacity; ++i) {
+            if(ctrl[i].load(std::memory_order_relaxed) == CTRL_EMPTY)
+                continue;
+
+            // word slots hand out copies, bound here so fn always gets lvalues
+            auto &&key = key_of(array->slots[i]);
+            auto &&value = value_of(array->slots[i]);
+            fn(key, value);
+        }
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void Concurrent_Map<K, V, Hash>::show(std::ostream &os) const {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Shards: " << std::setw(4) << shard_count() << std::endl;
+
+    for_each([&os](const K &key, const V &value) {
+        os << key << ": " << value << ", ";
+    });
+    os << std::endl;
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Concurrent_Map<K, V, Hash>::empty() const {
+    return (size() == 0);
+}
+
+template <typename K, typename V, typename Hash>
+size_t Concurrent_Map<K, V, Hash>::size() const {
+
+    size_t total = 0;
+    for(size_t s = 0; s < num_shards; ++s)
+        total += shards[s].num_elements.load(std::memory_order_relaxed);
+    return total;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Concurrent_Map<K, V, Hash>::shard_count() const {
+    return num_shards;
+}
+
+template <typename K, typename V, typename Hash>
+inline uint64_t Concurrent_Map<K, V, Hash>::hash_of(const K &key) const {
+    // the top bits pick the shard, the low 7 the control byte and the bits above them the slot
+    return hash_mix(hasher(key));
+}
+
+template <typename K, typename V, typename Hash>
+inline Concurrent_Map<K, V, Hash>::Shard& Concurrent_Map<K, V, Hash>::shard_of(uint64_t h) const {
+    return (num_shards == 1) ? (shards[0]) : (shards[h >> shard_shift]);
+}
+
+template <typename K, typename V, typename Hash>
+std::optional<V> Concurrent_Map<K, V, Hash>::find_locked(Shard &shard, const K &key, uint64_t h) const {
+
+    std::lock_guard<std::mutex> guard(shard.writer);
+    Slot_Array *array = shard.array.load(std::memory_order_relaxed);
+    if(array == nullptr)
+        return std::nullopt;
+
+    size_t i = probe(array, key, h);
+    if(ctrl_of(array)[i].load(std::memory_order_relaxed) == CTRL_EMPTY)
+        return std::nullopt;
+    return value_of(array->slots[i]);
+}
+
+template <typename K, typename V, typename Hash>
+void Concurrent_Map<K, V, Hash>::grow(Shard &shard) {
+
+    // called with the writer lock held; the old array stays allocated for optimistic readers
+    Slot_Array *old_array = shard.array.load(std::memory_order_relaxed);
+    size_t capacity = (old_array == nullptr) ? (MIN_CAPACITY) : (2 * old_array->capacity);
+    Slot_Array *array = allocate_array(capacity);
+    array->retired = old_array;
+
+    begin_write(shard);
+    if(old_array != nullptr) {
+        std::atomic<int8_t> *old_ctrl = ctrl_of(old_array), *ctrl = ctrl_of(array);
+        Slot *old_slots = old_array->slots, *slots = array->slots;
+        for(size_t i = 0; i < old_array->capacity; ++i) {
+            int8_t c = old_ctrl[i].load(std::memory_order_relaxed);
+            if(c == CTRL_EMPTY)
+                continue;
+
+            size_t j = home_of(hash_of(key_of(old_slots[i])), capacity - 1);
+            while(ctrl[j].load(std::memory_order_relaxed) != CTRL_EMPTY)
+                j = (j + 1) & (capacity - 1);
+
+            // the old array keeps its control bytes for readers still probing it
+            move_entry(slots[j], old_slots[i]);
+            ctrl[j].store(c, std::memory_order_relaxed);
+        }
+    }
+    shard.array.store(array, std::memory_order_release);
+    end_write(shard);
+}
+
+template <typename K, typename V, typename Hash>
+inline void Concurrent_Map<K, V, Hash>::begin_write(Shard &shard) {
+
+    // the counter turns odd before any slot changes
+    shard.seq.store(shard.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename K, typename V, typename Hash>
+inline void Concurrent_Map<K, V, Hash>::end_write(Shard &shard) {
+    shard.seq.store(shard.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+template <typename K, typename V, typename Hash>
+inline std::atomic<int8_t>* Concurrent_Map<K, V, Hash>::ctrl_of(Slot_Array *array) {
+    return reinterpret_cast<std::atomic<int8_t>*>(reinterpret_cast<std::byte*>(array) + CTRL_OFFSET);
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Concurrent_Map<K, V, Hash>::home_of(uint64_t h, size_t mask) {
+    return (h >> 7) & mask;
+}
+
+template <typename K, typename V, typename Hash>
+inline decltype(auto) Concurrent_Map<K, V, Hash>::key_of(Slot &slot) {
+
+    // a copy from word slots, which optimistic readers may be loading at the same time
+    if constexpr (WORD_SLOTS) return load_words<K>(slot.key);
+    else                      return *std::launder(reinterpret_cast<K*>(slot.key));
+}
+
+template <typename K, typename V, typename Hash>
+inline decltype(auto) Concurrent_Map<K, V, Hash>::value_of(Slot &slot) {
+
+    if constexpr (WORD_SLOTS) return load_words<V>(slot.value);
+    else                      return *std::launder(reinterpret_cast<V*>(slot.value));
+}
+
+template <typename K, typename V, typename Hash>
+inline void Concurrent_Map<K, V, Hash>::store_entry(Slot &slot, const K &key, const V &value) {
+
+    if constexpr (WORD_SLOTS) {
+        store_words(slot.key, key);
+        store_words(slot.value, value);
+    }
+    else {
+        ::new (static_cast<void*>(slot.key)) K(key);
+        ::new (static_cast<void*>(slot.value)) V(value);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+inline void Concurrent_Map<K, V, Hash>::store_value(Slot &slot, const V &value) {
+
+    if constexpr (WORD_SLOTS) store_words(slot.value, value);
+    else                      value_of(slot) = value;
+}
+
+template <typename K, typename V, typename Hash>
+inline void Concurrent_Map<K, V, Hash>::move_entry(Slot &to, Slot &from) {
+
+    // from is left without an entry
+    if constexpr (WORD_SLOTS) {
+        store_words(to.key, load_words<K>(from.key));
+        store_words(to.value, load_words<V>(from.value));
+    }
+    else {
+        ::new (static_cast<void*>(to.key)) K(std::move(key_of(from)));
+        ::new (static_cast<void*>(to.value)) V(std::move(value_of(from)));
+        destroy_entry(from);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+inline void Concurrent_Map<K, V, Hash>::destroy_entry(Slot &slot) {
+
+    if constexpr (!WORD_SLOTS) {
+        std::destroy_at(&key_of(slot));
+        std::destroy_at(&value_of(slot));
+    }
+}
+
+template <typename K, typename V, typename Hash>
+template <typename T, size_t N>
+inline T Concurrent_Map<K, V, Hash>::load_words(uint64_t (&words)[N]) {
+
+    uint64_t buffer[N];
+    for(size_t w = 0; w < N; ++w)
+        buffer[w] = std::atomic_ref<uint64_t>(words[w]).load(std::memory_order_relaxed);
+
+    alignas(T) std::byte object[sizeof(T)];
+    std::memcpy(object, buffer, sizeof(T));
+    return *std::launder(reinterpret_cast<T*>(object));
+}
+
+template <typename K, typename V, typename Hash>
+template <typename T, size_t N>
+inline void Concurrent_Map<K, V, Hash>::store_words(uint64_t (&words)[N], const T &object) {
+
+    uint64_t buffer[N] = {};
+    std::memcpy(buffer, &object, sizeof(T));
+    for(size_t w = 0; w < N; ++w)
+        std::atomic_ref<uint64_t>(words[w]).store(buffer[w], std::memory_order_relaxed);
+}
+
+template <typename K, typename V, typename Hash>
+size_t Concurrent_Map<K, V, Hash>::probe(Slot_Array *array, const K &key, uint64_t h) {
+
+    // the slot holding key, or the empty slot ending its run; the load limit keeps one empty
+    std::atomic<int8_t> *ctrl = ctrl_of(array);
+    int8_t h2 = static_cast<int8_t>(h & 0x7F);
+    size_t mask = array->capacity - 1;
+    for(size_t i = home_of(h, mask); ; i = (i + 1) & mask) {
+        int8_t c = ctrl[i].load(std::memory_order_relaxed);
+        if(c == CTRL_EMPTY || (c == h2 && key_of(array->slots[i]) == key))
+            return i;
+    }
+}
+
+template <typename K, typename V, typename Hash>
+size_t Concurrent_Map<K, V, Hash>::slots_offset(size_t capacity) {
+    return (CTRL_OFFSET + capacity + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+}
+
+template <typename K, typename V, typename Hash>
+Concurrent_Map<K, V, Hash>::Slot_Array* Concurrent_Map<K, V, Hash>::allocate_array(size_t capacity) {
+
+    size_t offset = slots_offset(capacity);
+    std::byte *raw = static_cast<std::byte*>(::operator new(offset + capacity * sizeof(Slot), std::align_val_t(ARRAY_ALIGN)));
+    Slot_Array *array = ::new (raw) Slot_Array{capacity, nullptr, reinterpret_cast<Slot*>(raw + offset)};
+    std::atomic<int8_t> *ctrl = ctrl_of(array);
+    for(size_t i = 0; i < capacity; ++i)
+        ::new (static_cast<void*>(&ctrl[i])) std::atomic<int8_t>(CTRL_EMPTY);
+    return array;
+}
+
+template <typename K, typename V, typename Hash>
+void Concurrent_Map<K, V, Hash>::destroy_array(Slot_Array *array, bool live) {
+
+    // only the live array still owns its entries
+    std::atomic<int8_t> *ctrl = ctrl_of(array);
+    for(size_t i = 0; i < array->capacity; ++i) {
+        if(live && ctrl[i].load(std::memory_order_relaxed) != CTRL_EMPTY)
+            destroy_entry(array->slots[i]);
+    }
+    ::operator delete(static_cast<void*>(array), std::align_val_t(ARRAY_ALIGN));
+}
+
+}
@@ -0,0 +1,486 @@
+#pragma once
+
+#include "hash_util.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <bit>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Declaration */
+namespace ds_imp {
+
+template <typename K, typename V>
+struct Cuckoo_Slot {
+    K key;
+    V value;
+};
+
+/*
+ * Bucketized cuckoo hashing: a key lives in one of BUCKET_SLOTS slots of its two candidate
+ * buckets, so a lookup reads at most two buckets. Each slot has a tag byte, the top 8 hash bits
+ * or TAG_EMPTY; the tags of both buckets are compared in one step and only matching slots are
+ * read. The second bucket is derived from the first and the tag alone, so an entry can be moved
+ * to its other bucket without rehashing the key. When both buckets are full, a breadth-first
+ * search looks for the shortest chain of such moves that ends at a free slot.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class Cuckoo_Table {
+
+    using Slot = Cuckoo_Slot<K, V>;
+
+    struct Path_Node {
+        size_t bucket;
+        size_t parent;                // NPOS for the two candidate buckets of the new key
+        size_t slot;                  // the slot of the parent bucket whose entry moves here
+    };
+
+    public:
+        Cuckoo_Table(size_t capacity = 0, float max_load = DEFAULT_MAX_LOAD);
+        ~Cuckoo_Table();
+
+        Cuckoo_Table(const Cuckoo_Table &other) = delete;
+        Cuckoo_Table& operator=(const Cuckoo_Table &other) = delete;
+        Cuckoo_Table(Cuckoo_Table &&other) noexcept;
+        Cuckoo_Table& operator=(Cuckoo_Table &&other) noexcept;
+
+        void insert(const K &key, const V &value);
+        void insert_or_update(const K &key, const V &value);
+        bool erase(const K &key);
+        V* find(const K &key);
+        const V* find(const K &key) const;
+        inline bool contains(const K &key) const;
+        void reserve(size_t n);
+        void clear();
+        template <typename Func>
+        void for_each(Func fn) const;
+        void show(std::ostream &os) const;
+        inline float load_factor() const;
+        inline float max_load_factor() const;
+        void max_load_factor(float max_load);
+        inline bool empty() const;
+        inline size_t size() const;
+        inline size_t capacity() const;
+
+        static constexpr size_t  BUCKET_SLOTS     = 8;
+        static constexpr size_t  MAX_PATH_NODES   = 512;
+        static constexpr float   DEFAULT_MAX_LOAD = 0.95f;
+        static constexpr uint8_t TAG_EMPTY        = 0;
+
+    private:
+        std::vector<uint8_t> tags;    // BUCKET_SLOTS bytes per bucket, capacity() in total
+        Slot *slots;
+        size_t num_buckets;           // a power of two, or zero before the first insert
+        size_t num_elements;
+        float max_load;
+        Hash hasher;
+        std::vector<Path_Node> path;  // reused by every eviction search
+
+        static constexpr size_t NPOS = SIZE_MAX;
+
+        inline size_t hash_of(const K &key) const;
+        inline uint8_t tag_of(size_t h) const;
+        inline size_t alt_bucket(size_t bucket, uint8_t tag) const;
+        inline uint32_t match(size_t bucket, uint8_t tag) const;
+        inline uint32_t match_pair(size_t b1, size_t b2, uint8_t tag) const;
+        inline size_t load_limit() const;
+        size_t find_index(const K &key, size_t h) const;
+        size_t find_path(size_t b1, size_t b2);
+        bool try_place(size_t h, Slot &slot);
+        void place(size_t h, Slot &&slot);
+        void rehash(size_t buckets);
+        void release();
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+template <typename K, typename V, typename Hash>
+Cuckoo_Table<K, V, Hash>::Cuckoo_Table(size_t capacity, float max_load)
+    : slots(nullptr),
+      num_buckets(0),
+      num_elements(0),
+      max_load(DEFAULT_MAX_LOAD) {
+
+    max_load_factor(max_load);
+    reserve(capacity);
+}
+
+template <typename K, typename V, typename Hash>
+Cuckoo_Table<K, V, Hash>::~Cuckoo_Table() {
+    release();
+}
+
+template <typename K, typename V, typename Hash>
+Cuckoo_Table<K, V, Hash>::Cuckoo_Table(Cuckoo_Table &&other) noexcept
+    : tags(std::move(other.tags)),
+      slots(other.slots),
+      num_buckets(other.num_buckets),
+      num_elements(other.num_elements),
+      max_load(other.max_load),
+      hasher(std::move(other.hasher)),
+      path(std::move(other.path)) {
+
+    other.tags.clear();
+    other.slots = nullptr;
+    other.num_buckets = other.num_elements = 0;
+}
+
+template <typename K, typename V, typename Hash>
+Cuckoo_Table<K, V, Hash>& Cuckoo_Table<K, V, Hash>::operator=(Cuckoo_Table &&other) noexcept {
+
+    if(this == &other) return *this;
+
+    release();
+    tags = std::move(other.tags);
+    slots = other.slots;
+    num_buckets = other.num_buckets;
+    num_elements = other.num_elements;
+    max_load = other.max_load;
+    hasher = std::move(other.hasher);
+    path = std::move(other.path);
+
+    other.tags.clear();
+    other.slots = nullptr;
+    other.num_buckets = other.num_elements = 0;
+    return *this;
+}
+
+template <typename K, typename V, typename Hash>
+void Cuckoo_Table<K, V, Hash>::insert(const K &key, const V &value) {
+
+    size_t h = hash_of(key);
+    if(find_index(key, h) != NPOS) {
+        throw std::runtime_error("The key has been in the Cuckoo_Table");
+    }
+
+    if(num_buckets == 0 || num_elements + 1 > load_limit())
+        rehash(std::max<size_t>(1, 2 * num_buckets));
+    place(h, Slot{key, value});
+}
+
+template <typename K, typename V, typename Hash>
+void Cuckoo_Table<K, V, Hash>::insert_or_update(const K &key, const V &value) {
+
+    size_t h = hash_of(key), i = find_index(key, h);
+    if(i != NPOS) {
+        slots[i].value = value;
+        return;
+    }
+
+    if(num_buckets == 0 || num_elements + 1 > load_limit())
+        rehash(std::max<size_t>(1, 2 * num_buckets));
+    place(h, Slot{key, value});
+}
+
+template <typename K, typename V, typename Hash>
+bool Cuckoo_Table<K, V, Hash>::erase(const K &key) {
+
+    // a lookup always reads both buckets, so a freed slot needs no tombstone
+    size_t i = find_index(key, hash_of(key));
+    if(i == NPOS)
+        return false;
+
+    std::destroy_at(&slots[i]);
+    tags[i] = TAG_EMPTY;
+    num_elements --;
+    return true;
+}
+
+template <typename K, typename V, typename Hash>
+V* Cuckoo_Table<K, V, Hash>::find(const K &key) {
+
+    size_t i = find_index(key, hash_of(key));
+    return (i == NPOS) ? (nullptr) : (&slots[i].value);
+}
+
+template <typename K, typename V, typename Hash>
+const V* Cuckoo_Table<K, V, Hash>::find(const K &key) const {
+
+    size_t i = find_index(key, hash_of(key));
+    return (i == NPOS) ? (nullptr) : (&slots[i].value);
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Cuckoo_Table<K, V, Hash>::contains(const K &key) const {
+    return find_index(key, hash_of(key)) != NPOS;
+}
+
+template <typename K, typename V, typename Hash>
+void Cuckoo_Table<K, V, Hash>::reserve(size_t n) {
+
+    // enough buckets that n keys stay under the max load
+    if(n == 0)
+        return;
+
+    size_t slots_needed = static_cast<size_t>(static_cast<double>(n) / max_load) + 1;
+    size_t buckets = std::bit_ceil((slots_needed + BUCKET_SLOTS - 1) / BUCKET_SLOTS);
+    if(buckets > num_buckets)
+        rehash(buckets);
+}
+
+template <typename K, typename V, typename Hash>
+void Cuckoo_Table<K, V, Hash>::clear() {
+
+    for(size_t i = 0; i < tags.size(); ++i) {
+        if(tags[i] != TAG_EMPTY) std::destroy_at(&slots[i]);
+    }
+    std::fill(tags.begin(), tags.end(), TAG_EMPTY);
+    num_elements = 0;
+}
+
+template <typename K, typename V, typename Hash>
+template <typename Func>
+void Cuckoo_Table<K, V, Hash>::for_each(Func fn) const {
+
+    for(size_t i = 0; i < tags.size(); ++i) {
+        if(tags[i] != TAG_EMPTY) fn(slots[i].key, slots[i].value);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void Cuckoo_Table<K, V, Hash>::show(std::ostream &os) const {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Capacity: " << std::setw(4) << capacity() << std::endl;
+
+    for_each([&os](const K &key, const V &value) {
+        os << key << ": " << value << ", ";
+    });
+    os << std::endl;
+}
+
+template <typename K, typename V, typename Hash>
+inline float Cuckoo_Table<K, V, Hash>::load_factor() const {
+    return (capacity() == 0) ? (0.0f) : (static_cast<float>(num_elements) / capacity());
+}
+
+template <typename K, typename V, typename Hash>
+inline float Cuckoo_Table<K, V, Hash>::max_load_factor() const {
+    return max_load;
+}
+
+template <typename K, typename V, typename Hash>
+void Cuckoo_Table<K, V, Hash>::max_load_factor(float max_load) {
+
+    if(!(max_load > 0.0f && max_load < 1.0f)) {
+        throw std::out_of_range("The max load is out of range");
+    }
+
+    this->max_load = max_load;
+    if(num_elements > load_limit())
+        reserve(num_elements);
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Cuckoo_Table<K, V, Hash>::empty() const {
+    return (size() == 0);
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Cuckoo_Table<K, V, Hash>::size() const {
+    return num_elements;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Cuckoo_Table<K, V, Hash>::capacity() const {
+    return num_buckets * BUCKET_SLOTS;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Cuckoo_Table<K, V, Hash>::hash_of(const K &key) const {
+    return hash_mix(hasher(key));
+}
+
+template <typename K, typename V, typename Hash>
+inline uint8_t Cuckoo_Table<K, V, Hash>::tag_of(size_t h) const {
+
+    // the top byte, while the low bits pick the first bucket; zero is kept for empty slots
+    uint8_t tag = static_cast<uint8_t>(h >> 56);
+    return (tag == TAG_EMPTY) ? (1) : (tag);
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Cuckoo_Table<K, V, Hash>::alt_bucket(size_t bucket, uint8_t tag) const {
+
+    // an involution: applied to either bucket of an entry it gives the other one
+    return (bucket ^ (static_cast<size_t>(tag) * 0x5bd1e995)) & (num_buckets - 1);
+}
+
+template <typename K, typename V, typename Hash>
+inline uint32_t Cuckoo_Table<K, V, Hash>::match(size_t bucket, uint8_t tag) const {
+
+    // bit j is set when the tag of slot j of the bucket equals tag
+    const uint8_t *base = tags.data() + bucket * BUCKET_SLOTS;
+#if defined(__SSE2__)
+    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(base));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(tag))))) & 0xFF;
+#else
+    uint32_t mask = 0;
+    for(size_t j = 0; j < BUCKET_SLOTS; ++j)
+        mask |= static_cast<uint32_t>(base[j] == tag) << j;
+    return mask;
+#endif
+}
+
+template <typename K, typename V, typename Hash>
+inline uint32_t Cuckoo_Table<K, V, Hash>::match_pair(size_t b1, size_t b2, uint8_t tag) const {
+
+    // both buckets in one compare: the low BUCKET_SLOTS bits are b1, the next BUCKET_SLOTS are b2
+#if defined(__SSE2__)
+    __m128i lo = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(tags.data() + b1 * BUCKET_SLOTS));
+    __m128i hi = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(tags.data() + b2 * BUCKET_SLOTS));
+    __m128i bytes = _mm_unpacklo_epi64(lo, hi);
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(tag)))));
+#else
+    return match(b1, tag) | (match(b2, tag) << BUCKET_SLOTS);
+#endif
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Cuckoo_Table<K, V, Hash>::load_limit() const {
+    return static_cast<size_t>(capacity() * static_cast<double>(max_load));
+}
+
+template <typename K, typename V, typename Hash>
+size_t Cuckoo_Table<K, V, Hash>::find_index(const K &key, size_t h) const {
+
+    if(num_buckets == 0)
+        return NPOS;
+
+    uint8_t tag = tag_of(h);
+    size_t b1 = h & (num_buckets - 1), b2 = alt_bucket(b1, tag);
+
+    for(uint32_t mask = match_pair(b1, b2, tag); mask != 0; mask &= mask - 1) {
+        size_t j = std::countr_zero(mask);
+        size_t i = (j < BUCKET_SLOTS) ? (b1 * BUCKET_SLOTS + j) : (b2 * BUCKET_SLOTS + j - BUCKET_SLOTS);
+        if(slots[i].key == key)
+            return i;
+    }
+    return NPOS;
+}
+
+template <typename K, typename V, typename Hash>
+size_t Cuckoo_Table<K, V, Hash>::find_path(size_t b1, size_t b2) {
+
+    // breadth-first over the buckets reachable by moving one entry to its other bucket,
+    // so the chain found is the shortest; returns the node whose bucket has a free slot.
+    // A bucket is visited once, so no slot is on a chain twice and every move stays valid
+    path.clear();
+    path.push_back(Path_Node{b1, NPOS, 0});
+    if(b2 != b1)
+        path.push_back(Path_Node{b2, NPOS, 0});
+
+    for(size_t k = 0; k < path.size() && path.size() < MAX_PATH_NODES; ++k) {
+        size_t bucket = path[k].bucket;
+        for(size_t j = 0; j < BUCKET_SLOTS; ++j) {
+            size_t next = alt_bucket(bucket, tags[bucket * BUCKET_SLOTS + j]);
+            if(std::any_of(path.begin(), path.end(), [next](const Path_Node &node) { return node.bucket == next; }))
+                continue;
+
+            path.push_back(Path_Node{next, k, j});
+            if(match(next, TAG_EMPTY) != 0)
+                return path.size() - 1;
+        }
+    }
+    return NPOS;
+}
+
+template <typename K, typename V, typename Hash>
+bool Cuckoo_Table<K, V, Hash>::try_place(size_t h, Slot &slot) {
+
+    uint8_t tag = tag_of(h);
+    size_t b1 = h & (num_buckets - 1), b2 = alt_bucket(b1, tag);
+
+    size_t i = NPOS;
+    if(uint32_t empty_mask = match_pair(b1, b2, TAG_EMPTY); empty_mask != 0) {
+        size_t j = std::countr_zero(empty_mask);
+        i = (j < BUCKET_SLOTS) ? (b1 * BUCKET_SLOTS + j) : (b2 * BUCKET_SLOTS + j - BUCKET_SLOTS);
+    }
+    else {
+        size_t k = find_path(b1, b2);
+        if(k == NPOS)
+            return false;
+
+        // walk the chain backwards, so every entry moves into a slot that is already free
+        i = path[k].bucket * BUCKET_SLOTS + std::countr_zero(match(path[k].bucket, TAG_EMPTY));
+        for(; path[k].parent != NPOS; k = path[k].parent) {
+            size_t from = path[path[k].parent].bucket * BUCKET_SLOTS + path[k].slot;
+            std::construct_at(&slots[i], std::move(slots[from]));
+            std::destroy_at(&slots[from]);
+            tags[i] = std::exchange(tags[from], TAG_EMPTY);
+            i = from;
+        }
+    }
+
+    std::construct_at(&slots[i], std::move(slot));
+    tags[i] = tag;
+    num_elements ++;
+    return true;
+}
+
+template <typename K, typename V, typename Hash>
+void Cuckoo_Table<K, V, Hash>::place(size_t h, Slot &&slot) {
+
+    // no chain within MAX_PATH_NODES: the table grows and the entry is tried again
+    while(!try_place(h, slot)) {
+        // no chain in a table this sparse means more than 2 * BUCKET_SLOTS keys share their
+        // hash, and more buckets would not separate them
+        if(8 * num_elements < capacity()) {
+            throw std::runtime_error("The keys collide too often in the Cuckoo_Table");
+        }
+        rehash(2 * num_buckets);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void Cuckoo_Table<K, V, Hash>::rehash(size_t buckets) {
+
+    std::vector<uint8_t> old_tags = std::exchange(tags, std::vector<uint8_t>(buckets * BUCKET_SLOTS, TAG_EMPTY));
+    Slot *old_slots = std::exchange(slots, std::allocator<Slot>().allocate(buckets * BUCKET_SLOTS));
+    num_buckets = buckets;
+    num_elements = 0;
+
+    // the entries fit the smaller table, so they fit this one and need no collision check; a
+    // chain cut off by MAX_PATH_NODES grows it again, the old arrays stay local until drained
+    for(size_t i = 0; i < old_tags.size(); ++i) {
+        if(old_tags[i] == TAG_EMPTY)
+            continue;
+
+        size_t h = hash_of(old_slots[i].key);
+        while(!try_place(h, old_slots[i]))
+            rehash(2 * num_buckets);
+        std::destroy_at(&old_slots[i]);
+    }
+
+    if(old_slots != nullptr)
+        std::allocator<Slot>().deallocate(old_slots, old_tags.size());
+}
+
+template <typename K, typename V, typename Hash>
+void Cuckoo_Table<K, V, Hash>::release() {
+
+    if(slots == nullptr)
+        return;
+
+    clear();
+    std::allocator<Slot>().deallocate(slots, capacity());
+    slots = nullptr;
+    tags.clear();
+    num_buckets = 0;
+}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* Declaration */
+namespace ds_imp {
+
+inline size_t hash_mix(size_t h);
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+inline size_t hash_mix(size_t h) {
+
+    // the MurmurHash3 finalizer: std::hash of an integer is usually the identity,
+    // so the tables spread it over every bit before taking control bits or bucket indices
+    uint64_t x = static_cast<uint64_t>(h);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return static_cast<size_t>(x);
+}
+
+}
@@ -0,0 +1,507 @@
+#pragma once
+
+#include "hash_util.hpp"
+#include "../others/mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <span>
+#include <optional>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <bit>
+#include <algorithm>
+
+/* Declaration */
+namespace ds_imp {
+
+struct Mph_Partition {
+    uint64_t key_offset;      // the first index this partition hands out
+    uint64_t bucket_offset;   // its first pilot
+    uint64_t remap_offset;    // its first remap entry
+    uint32_t num_keys;
+    uint32_t table_size;      // positions [num_keys, table_size) are remapped below num_keys
+    uint32_t num_buckets;
+    uint32_t reserved;
+};
+
+/*
+ * Minimal perfect hash for a static key set, built PTHash-style: keys are split into partitions
+ * built in parallel; inside a partition they fall into skewed buckets, and each bucket gets the
+ * first pilot that sends all of its keys to free positions of a table 1% larger than the partition.
+ * A lookup reads one bit-packed pilot; the 1% of keys that land past the partition end take one
+ * more read from the remap array. Every array lives in one word image that save() writes as is,
+ * so a saved hash can be used straight from a Mapped_File.
+ */
+template <typename K, typename Hash = std::hash<K>>
+class Perfect_Hash {
+
+    public:
+        Perfect_Hash();
+        Perfect_Hash(std::span<const K> keys, size_t num_threads = 0, uint64_t seed = DEFAULT_SEED);
+        explicit Perfect_Hash(Mapped_File &&file);
+        ~Perfect_Hash();
+
+        Perfect_Hash(const Perfect_Hash &other) = delete;
+        Perfect_Hash& operator=(const Perfect_Hash &other) = delete;
+        Perfect_Hash(Perfect_Hash &&other) noexcept;
+        Perfect_Hash& operator=(Perfect_Hash &&other) noexcept;
+
+        size_t operator()(const K &key) const;
+        void save(const std::string &path) const;
+        void show(std::ostream &os) const;
+        inline double bits_per_key() const;
+        inline bool empty() const;
+        inline size_t size() const;
+
+        static constexpr uint64_t DEFAULT_SEED    = 0x2545f4914f6cdd1dULL;
+        static constexpr uint64_t MAGIC           = 0x314850484d495344ULL;   // "DSIMPHP1"
+        static constexpr size_t   PARTITION_KEYS  = 1 << 18;
+        static constexpr double   BUCKET_KEYS     = 5.0;     // average keys per bucket
+        static constexpr double   TABLE_LOAD      = 0.99;    // partition keys / table positions
+
+    private:
+        enum Header_Word { HEAD_MAGIC, HEAD_KEYS, HEAD_SEED, HEAD_PARTITIONS, HEAD_PILOT_BITS, HEAD_REMAP_BITS, HEAD_PILOT_WORDS, HEAD_REMAP_WORDS, HEADER_WORDS };
+
+        struct Partition_Result {
+            std::vector<uint64_t> pilots;
+            std::vector<uint64_t> remap;
+            uint32_t table_size;
+        };
+
+        std::vector<uint64_t> image;    // the serialized form when the hash was built here
+        std::optional<Mapped_File> source; // or the mapping it was loaded from
+        const Mph_Partition *parts;
+        const uint64_t *pilots;
+        const uint64_t *remap;
+        uint64_t num_keys;
+        uint64_t seed;
+        uint64_t num_partitions;
+        uint64_t pilot_bits;
+        uint64_t remap_bits;
+        uint64_t image_words;
+        Hash hasher;
+
+        void attach(const uint64_t *base, size_t words);
+        static Partition_Result build_partition(std::span<const uint64_t> hashes);
+        static inline uint64_t fastrange(uint64_t h, uint64_t n);
+        static inline uint64_t bucket_of(uint64_t h, uint64_t num_buckets);
+        static inline uint64_t pilot_hash(uint64_t pilot);
+        static inline uint64_t position(uint64_t h, uint64_t pilot_mix, uint64_t table_size);
+        static inline uint64_t read_bits(const uint64_t *words, uint64_t i, uint64_t width);
+        static inline void write_bits(uint64_t *words, uint64_t i, uint64_t width, uint64_t value);
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+template <typename K, typename Hash>
+Perfect_Hash<K, Hash>::Perfect_Hash()
+    : parts(nullptr),
+      pilots(nullptr),
+      remap(nullptr),
+      num_keys(0),
+      seed(DEFAULT_SEED),
+      num_partitions(0),
+      pilot_bits(0),
+      remap_bits(0),
+      image_words(0) {}
+
+template <typename K, typename Hash>
+Perfect_Hash<K, Hash>::Perfect_Hash(std::span<const K> keys, size_t num_threads, uint64_t seed) : Perfect_Hash() {
+
+    if(num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    size_t n = keys.size();
+    size_t partitions = std::max<size_t>(1, (n + PARTITION_KEYS - 1) / PARTITION_KEYS);
+    if(n / partitions >= UINT32_MAX / 2) {
+        throw std::length_error("The partition is too large for the Perfect_Hash");
+    }
+
+    // workers claim chunks from a shared counter; the first exception is kept and rethrown
+    auto run_parallel = [num_threads](size_t count, auto &&work) {
+        std::atomic<size_t> next(0);
+        std::exception_ptr error;
+        std::atomic<bool> failed(false);
+
+        auto worker = [&]() {
+            try {
+                for(size_t i = next ++; i < count && !failed; i = next ++)
+                    work(i);
+            }
+            catch(...) {
+                if(!failed.exchange(true)) error = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(size_t t = 1; t < std::min(num_threads, count); ++t)
+            threads.emplace_back(worker);
+        worker();
+        for(auto &thread : threads)
+            thread.join();
+
+        if(error) std::rethrow_exception(error);
+    };
+
+    // 1. hash every key, then counting-sort the hashes by partition
+    constexpr size_t CHUNK = 1 << 16;
+    std::vector<uint64_t> hashes(n);
+    run_parallel((n + CHUNK - 1) / CHUNK, [&](size_t c) {
+        for(size_t i = c * CHUNK; i < std::min(n, (c + 1) * CHUNK); ++i)
+            hashes[i] = hash_mix(hasher(keys[i]) ^ seed);
+    });
+
+    std::vector<uint64_t> starts(partitions + 1, 0);
+    for(uint64_t h : hashes)
+        starts[fastrange(h, partitions) + 1] ++;
+    for(size_t p = 0; p < partitions; ++p)
+        starts[p + 1] += starts[p];
+
+    std::vector<uint64_t> grouped(n);
+    {
+        std::vector<uint64_t> fill(starts.begin(), starts.end() - 1);
+        for(uint64_t h : hashes)
+            grouped[fill[fastrange(h, partitions)] ++] = h;
+    }
+    std::vector<uint64_t>().swap(hashes);
+
+    // 2. each partition is an independent search
+    std::vector<Partition_Result> results(partitions);
+    run_parallel(partitions, [&](size_t p) {
+        results[p] = build_partition(std::span<const uint64_t>(grouped.data() + starts[p], starts[p + 1] - starts[p]));
+    });
+    std::vector<uint64_t>().swap(grouped);
+
+    // 3. lay the results out as one image
+    uint64_t max_pilot = 0, max_keys = 1, total_buckets = 0, total_remap = 0;
+    for(size_t p = 0; p < partitions; ++p) {
+        for(uint64_t pilot : results[p].pilots)
+            max_pilot = std::max(max_pilot, pilot);
+        max_keys = std::max<uint64_t>(max_keys, starts[p + 1] - starts[p]);
+        total_buckets += results[p].pilots.size();
+        total_remap += results[p].remap.size();
+    }
+
+    uint64_t p_bits = std::max<uint64_t>(1, std::bit_width(max_pilot));
+    uint64_t r_bits = std::max<uint64_t>(1, std::bit_width(max_keys - 1));
+    uint64_t pilot_words = (total_buckets * p_bits + 63) / 64 + 1;   // one spare word for two-word reads
+    uint64_t remap_words = (total_remap * r_bits + 63) / 64 + 1;
+    uint64_t part_words = partitions * sizeof(Mph_Partition) / sizeof(uint64_t);
+
+    image.assign(HEADER_WORDS + part_words + pilot_words + remap_words, 0);
+    image[HEAD_MAGIC] = MAGIC;
+    image[HEAD_KEYS] = n;
+    image[HEAD_SEED] = seed;
+    image[HEAD_PARTITIONS] = partitions;
+    image[HEAD_PILOT_BITS] = p_bits;
+    image[HEAD_REMAP_BITS] = r_bits;
+    image[HEAD_PILOT_WORDS] = pilot_words;
+    image[HEAD_REMAP_WORDS] = remap_words;
+
+    uint64_t *part_base = image.data() + HEADER_WORDS;
+    uint64_t *pilot_base = part_base + part_words;
+    uint64_t *remap_base = pilot_base + pilot_words;
+    uint64_t bucket_offset = 0, remap_offset = 0;
+
+    for(size_t p = 0; p < partitions; ++p) {
+        Mph_Partition part{};
+        part.key_offset = starts[p];
+        part.bucket_offset = bucket_offset;
+        part.remap_offset = remap_offset;
+        part.num_keys = static_cast<uint32_t>(starts[p + 1] - starts[p]);
+        part.table_size = results[p].table_size;
+        part.num_buckets = static_cast<uint32_t>(results[p].pilots.size());
+        std::memcpy(part_base + p * sizeof(Mph_Partition) / sizeof(uint64_t), &part, sizeof(Mph_Partition));
+
+        for(uint64_t pilot : results[p].pilots)
+            write_bits(pilot_base, bucket_offset ++, p_bits, pilot);
+        for(uint64_t target : results[p].remap)
+            write_bits(remap_base, remap_offset ++, r_bits, target);
+        results[p] = Partition_Result();
+    }
+
+    attach(image.data(), image.size());
+}
+
+template <typename K, typename Hash>
+Perfect_Hash<K, Hash>::Perfect_Hash(Mapped_File &&file) : Perfect_Hash() {
+
+    source.emplace(std::move(file));
+    std::string_view bytes = source->view();
+    if(bytes.size() % sizeof(uint64_t) != 0) {
+        throw std::runtime_error("The file is not a Perfect_Hash image");
+    }
+    attach(reinterpret_cast<const uint64_t*>(bytes.data()), bytes.size() / sizeof(uint64_t));
+}
+
+template <typename K, typename Hash>
+Perfect_Hash<K, Hash>::~Perfect_Hash() = default;
+
+template <typename K, typename Hash>
+Perfect_Hash<K, Hash>::Perfect_Hash(Perfect_Hash &&other) noexcept : Perfect_Hash() {
+    *this = std::move(other);
+}
+
+template <typename K, typename Hash>
+Perfect_Hash<K, Hash>& Perfect_Hash<K, Hash>::operator=(Perfect_Hash &&other) noexcept {
+
+    if(this == &other) return *this;
+
+    // the views point into the image or the mapping, and both keep their addresses when moved
+    image = std::move(other.image);
+    source = std::move(other.source);
+    parts = other.parts;
+    pilots = other.pilots;
+    remap = other.remap;
+    num_keys = other.num_keys;
+    seed = other.seed;
+    num_partitions = other.num_partitions;
+    pilot_bits = other.pilot_bits;
+    remap_bits = other.remap_bits;
+    image_words = other.image_words;
+    hasher = std::move(other.hasher);
+
+    other.image.clear();
+    other.source.reset();
+    other.parts = nullptr;
+    other.pilots = other.remap = nullptr;
+    other.num_keys = other.num_partitions = other.image_words = 0;
+    return *this;
+}
+
+template <typename K, typename Hash>
+size_t Perfect_Hash<K, Hash>::operator()(const K &key) const {
+
+    // a distinct index in [0, size()) for every key of the set, and some index for any other key
+    if(num_keys == 0) {
+        throw std::out_of_range("The Perfect_Hash is empty");
+    }
+
+    uint64_t h = hash_mix(hasher(key) ^ seed);
+    const Mph_Partition &part = parts[fastrange(h, num_partitions)];
+    if(part.num_keys == 0)
+        return 0;
+
+    uint64_t pilot = read_bits(pilots, part.bucket_offset + bucket_of(h, part.num_buckets), pilot_bits);
+    uint64_t pos = position(h, pilot_hash(pilot), part.table_size);
+
+    if(pos < part.num_keys)
+        return part.key_offset + pos;
+    return part.key_offset + read_bits(remap, part.remap_offset + pos - part.num_keys, remap_bits);
+}
+
+template <typename K, typename Hash>
+void Perfect_Hash<K, Hash>::save(const std::string &path) const {
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    const uint64_t *base = (image.empty()) ? (reinterpret_cast<const uint64_t*>(source->view().data())) : (image.data());
+    if(image_words > 0)
+        out.write(reinterpret_cast<const char*>(base), image_words * sizeof(uint64_t));
+
+    if(!out) {
+        throw std::runtime_error("Cannot write the Perfect_Hash file");
+    }
+}
+
+template <typename K, typename Hash>
+void Perfect_Hash<K, Hash>::show(std::ostream &os) const {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Partitions: " << std::setw(4) << num_partitions << ", ";
+    os << "Pilot bits: " << std::setw(2) << pilot_bits << ", ";
+    os << "Bits per key: " << std::fixed << std::setprecision(2) << bits_per_key() << std::endl;
+}
+
+template <typename K, typename Hash>
+inline double Perfect_Hash<K, Hash>::bits_per_key() const {
+    return (num_keys == 0) ? (0.0) : (64.0 * image_words / num_keys);
+}
+
+template <typename K, typename Hash>
+inline bool Perfect_Hash<K, Hash>::empty() const {
+    return (size() == 0);
+}
+
+template <typename K, typename Hash>
+inline size_t Perfect_Hash<K, Hash>::size() const {
+    return num_keys;
+}
+
+template <typename K, typename Hash>
+void Perfect_Hash<K, Hash>::attach(const uint64_t *base, size_t words) {
+
+    auto fail = []() { throw std::runtime_error("The file is not a Perfect_Hash image"); };
+
+    if(words < HEADER_WORDS || base[HEAD_MAGIC] != MAGIC)
+        fail();
+
+    uint64_t part_words = base[HEAD_PARTITIONS] * sizeof(Mph_Partition) / sizeof(uint64_t);
+    if(base[HEAD_PARTITIONS] > words || base[HEAD_PILOT_BITS] > 64 || base[HEAD_REMAP_BITS] > 64 ||
+       HEADER_WORDS + part_words + base[HEAD_PILOT_WORDS] + base[HEAD_REMAP_WORDS] != words)
+        fail();
+
+    num_keys = base[HEAD_KEYS];
+    seed = base[HEAD_SEED];
+    num_partitions = base[HEAD_PARTITIONS];
+    pilot_bits = base[HEAD_PILOT_BITS];
+    remap_bits = base[HEAD_REMAP_BITS];
+    image_words = words;
+
+    parts = reinterpret_cast<const Mph_Partition*>(base + HEADER_WORDS);
+    pilots = base + HEADER_WORDS + part_words;
+    remap = pilots + base[HEAD_PILOT_WORDS];
+}
+
+template <typename K, typename Hash>
+Perfect_Hash<K, Hash>::Partition_Result Perfect_Hash<K, Hash>::build_partition(std::span<const uint64_t> hashes) {
+
+    Partition_Result result;
+    uint64_t n = hashes.size();
+    uint64_t m = std::max<uint64_t>(2, static_cast<uint64_t>(std::ceil(n / BUCKET_KEYS)));
+    uint64_t table_size = std::max<uint64_t>(n, static_cast<uint64_t>(std::ceil(n / TABLE_LOAD)));
+    result.table_size = static_cast<uint32_t>(table_size);
+    result.pilots.assign(m, 0);
+
+    // counting sort the keys by bucket, then the buckets by size, largest first
+    std::vector<uint32_t> bucket_start(m + 1, 0);
+    for(uint64_t h : hashes)
+        bucket_start[bucket_of(h, m) + 1] ++;
+    for(uint64_t b = 0; b < m; ++b)
+        bucket_start[b + 1] += bucket_start[b];
+
+    std::vector<uint64_t> by_bucket(n);
+    {
+        std::vector<uint32_t> fill(bucket_start.begin(), bucket_start.end() - 1);
+        for(uint64_t h : hashes)
+            by_bucket[fill[bucket_of(h, m)] ++] = h;
+    }
+
+    uint32_t max_size = 0;
+    for(uint64_t b = 0; b < m; ++b)
+        max_size = std::max(max_size, bucket_start[b + 1] - bucket_start[b]);
+
+    std::vector<uint32_t> size_start(max_size + 2, 0), order(m);
+    for(uint64_t b = 0; b < m; ++b)
+        size_start[max_size - (bucket_start[b + 1] - bucket_start[b]) + 1] ++;
+    for(uint32_t s = 0; s <= max_size; ++s)
+        size_start[s + 1] += size_start[s];
+    for(uint64_t b = 0; b < m; ++b)
+        order[size_start[max_size - (bucket_start[b + 1] - bucket_start[b])] ++] = static_cast<uint32_t>(b);
+
+    // the first pilot that puts every key of the bucket on a distinct free position
+    std::vector<uint64_t> taken((table_size + 63) / 64, 0);
+    std::vector<uint64_t> positions(max_size);
+
+    for(uint32_t b : order) {
+        const uint64_t *first = by_bucket.data() + bucket_start[b];
+        uint32_t size = bucket_start[b + 1] - bucket_start[b];
+        if(size == 0)
+            break;
+
+        for(uint32_t i = 0; i < size; ++i) {
+            for(uint32_t j = 0; j < i; ++j) {
+                if(first[i] == first[j]) {
+                    throw std::runtime_error("The keys have colliding hashes");
+                }
+            }
+        }
+
+        for(uint64_t pilot = 0; ; ++pilot) {
+            uint64_t mix = pilot_hash(pilot);
+            uint32_t placed = 0;
+
+            for(; placed < size; ++placed) {
+                uint64_t pos = position(first[placed], mix, table_size);
+                if((taken[pos >> 6] >> (pos & 63)) & 1)
+                    break;
+                if(std::find(positions.begin(), positions.begin() + placed, pos) != positions.begin() + placed)
+                    break;
+                positions[placed] = pos;
+            }
+
+            if(placed == size) {
+                for(uint32_t i = 0; i < size; ++i)
+                    taken[positions[i] >> 6] |= static_cast<uint64_t>(1) << (positions[i] & 63);
+                result.pilots[b] = pilot;
+                break;
+            }
+        }
+    }
+
+    // a taken position past n points at one of the free positions below n
+    result.remap.assign(table_size - n, 0);
+    uint64_t free_pos = 0;
+    for(uint64_t pos = n; pos < table_size; ++pos) {
+        if(((taken[pos >> 6] >> (pos & 63)) & 1) == 0)
+            continue;
+        while((taken[free_pos >> 6] >> (free_pos & 63)) & 1)
+            free_pos ++;
+        result.remap[pos - n] = free_pos ++;
+    }
+    return result;
+}
+
+template <typename K, typename Hash>
+inline uint64_t Perfect_Hash<K, Hash>::fastrange(uint64_t h, uint64_t n) {
+    // h scaled onto [0, n) by its high bits
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(h) * n) >> 64);
+}
+
+template <typename K, typename Hash>
+inline uint64_t Perfect_Hash<K, Hash>::bucket_of(uint64_t h, uint64_t num_buckets) {
+
+    // skewed: 60% of the keys share the first 30% of the buckets, which are then placed
+    // while the table is still empty; the partition already used the high bits of h
+    uint64_t g = hash_mix(h + 0x9e3779b97f4a7c15ULL);
+    uint64_t dense = std::max<uint64_t>(1, num_buckets * 3 / 10);
+    uint64_t r = g >> 32;
+
+    if((g & 0xFFFFFFFFULL) < 0x99999999ULL)
+        return (r * dense) >> 32;
+    return dense + ((r * (num_buckets - dense)) >> 32);
+}
+
+template <typename K, typename Hash>
+inline uint64_t Perfect_Hash<K, Hash>::pilot_hash(uint64_t pilot) {
+    return hash_mix(pilot + 0x632be59bd9b4e019ULL);
+}
+
+template <typename K, typename Hash>
+inline uint64_t Perfect_Hash<K, Hash>::position(uint64_t h, uint64_t pilot_mix, uint64_t table_size) {
+    return fastrange(hash_mix(h ^ pilot_mix), table_size);
+}
+
+template <typename K, typename Hash>
+inline uint64_t Perfect_Hash<K, Hash>::read_bits(const uint64_t *words, uint64_t i, uint64_t width) {
+
+    // the width-bit entry i; the arrays carry a spare word, so reading the next one is safe
+    uint64_t bit = i * width, w = bit >> 6, shift = bit & 63;
+    uint64_t mask = (width == 64) ? (~0ULL) : ((1ULL << width) - 1);
+    uint64_t low = words[w] >> shift;
+    uint64_t high = (shift == 0) ? (0) : (words[w + 1] << (64 - shift));
+    return (low | high) & mask;
+}
+
+template <typename K, typename Hash>
+inline void Perfect_Hash<K, Hash>::write_bits(uint64_t *words, uint64_t i, uint64_t width, uint64_t value) {
+
+    uint64_t bit = i * width, w = bit >> 6, shift = bit & 63;
+    words[w] |= value << shift;
+    if(shift + width > 64)
+        words[w + 1] |= value >> (64 - shift);
+}
+
+}
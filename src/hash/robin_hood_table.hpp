@@ -0,0 +1,408 @@
+#pragma once
+
+#include "hash_util.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <bit>
+#include <algorithm>
+
+/* Declaration */
+namespace ds_imp {
+
+template <typename K, typename V>
+struct Robin_Hood_Slot {
+    K key;
+    V value;
+};
+
+/*
+ * Linear probing where a new key goes ahead of the first entry closer to its home than the key
+ * would be, and the rest of the run moves one slot on, so every run stays sorted by home. Each
+ * slot records its probe length: a lookup stops at the first entry nearer its home than the key
+ * would be, and only compares keys whose probe length matches. Erase shifts the rest of the run
+ * back by one slot instead of leaving a tombstone, so a steady insert/erase stream never
+ * degrades the table.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class Robin_Hood_Table {
+
+    using Slot = Robin_Hood_Slot<K, V>;
+
+    public:
+        Robin_Hood_Table(size_t capacity = 0, float max_load = DEFAULT_MAX_LOAD);
+        ~Robin_Hood_Table();
+
+        Robin_Hood_Table(const Robin_Hood_Table &other) = delete;
+        Robin_Hood_Table& operator=(const Robin_Hood_Table &other) = delete;
+        Robin_Hood_Table(Robin_Hood_Table &&other) noexcept;
+        Robin_Hood_Table& operator=(Robin_Hood_Table &&other) noexcept;
+
+        void insert(const K &key, const V &value);
+        void insert_or_update(const K &key, const V &value);
+        bool erase(const K &key);
+        V* find(const K &key);
+        const V* find(const K &key) const;
+        inline bool contains(const K &key) const;
+        void reserve(size_t n);
+        void clear();
+        template <typename Func>
+        void for_each(Func fn) const;
+        void show(std::ostream &os) const;
+        inline float load_factor() const;
+        inline float max_load_factor() const;
+        void max_load_factor(float max_load);
+        inline bool empty() const;
+        inline size_t size() const;
+        inline size_t capacity() const;
+
+        static constexpr float   DEFAULT_MAX_LOAD = 0.95f;
+        static constexpr uint8_t DIST_EMPTY       = 0;
+        static constexpr uint8_t DIST_LIMIT       = 255;     // probes reaching it grow the table
+
+    private:
+        std::vector<uint8_t> dist;    // probe length + 1 of each slot, DIST_EMPTY when free
+        Slot *slots;
+        size_t num_slots;             // a power of two, or zero before the first insert
+        size_t num_elements;
+        float max_load;
+        Hash hasher;
+
+        static constexpr size_t NPOS = SIZE_MAX;
+
+        inline size_t hash_of(const K &key) const;
+        inline size_t load_limit() const;
+        size_t find_index(const K &key, size_t h) const;
+        void insert_new(size_t h, Slot &&slot);
+        bool place(size_t h, Slot &slot);
+        void rehash(size_t capacity);
+        void release();
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+template <typename K, typename V, typename Hash>
+Robin_Hood_Table<K, V, Hash>::Robin_Hood_Table(size_t capacity, float max_load)
+    : slots(nullptr),
+      num_slots(0),
+      num_elements(0),
+      max_load(DEFAULT_MAX_LOAD) {
+
+    max_load_factor(max_load);
+    reserve(capacity);
+}
+
+template <typename K, typename V, typename Hash>
+Robin_Hood_Table<K, V, Hash>::~Robin_Hood_Table() {
+    release();
+}
+
+template <typename K, typename V, typename Hash>
+Robin_Hood_Table<K, V, Hash>::Robin_Hood_Table(Robin_Hood_Table &&other) noexcept
+    : dist(std::move(other.dist)),
+      slots(other.slots),
+      num_slots(other.num_slots),
+      num_elements(other.num_elements),
+      max_load(other.max_load),
+      hasher(std::move(other.hasher)) {
+
+    other.dist.clear();
+    other.slots = nullptr;
+    other.num_slots = other.num_elements = 0;
+}
+
+template <typename K, typename V, typename Hash>
+Robin_Hood_Table<K, V, Hash>& Robin_Hood_Table<K, V, Hash>::operator=(Robin_Hood_Table &&other) noexcept {
+
+    if(this == &other) return *this;
+
+    release();
+    dist = std::move(other.dist);
+    slots = other.slots;
+    num_slots = other.num_slots;
+    num_elements = other.num_elements;
+    max_load = other.max_load;
+    hasher = std::move(other.hasher);
+
+    other.dist.clear();
+    other.slots = nullptr;
+    other.num_slots = other.num_elements = 0;
+    return *this;
+}
+
+template <typename K, typename V, typename Hash>
+void Robin_Hood_Table<K, V, Hash>::insert(const K &key, const V &value) {
+
+    size_t h = hash_of(key);
+    if(find_index(key, h) != NPOS) {
+        throw std::runtime_error("The key has been in the Robin_Hood_Table");
+    }
+
+    insert_new(h, Slot{key, value});
+}
+
+template <typename K, typename V, typename Hash>
+void Robin_Hood_Table<K, V, Hash>::insert_or_update(const K &key, const V &value) {
+
+    size_t h = hash_of(key), i = find_index(key, h);
+    if(i != NPOS) {
+        slots[i].value = value;
+        return;
+    }
+
+    insert_new(h, Slot{key, value});
+}
+
+template <typename K, typename V, typename Hash>
+bool Robin_Hood_Table<K, V, Hash>::erase(const K &key) {
+
+    size_t i = find_index(key, hash_of(key));
+    if(i == NPOS)
+        return false;
+
+    // backward shift: the entries after the hole move one slot closer to their homes
+    // until the run ends at an empty slot or at an entry already at its home; the arrays are
+    // read through locals, as a store to a uint8_t could alias the members
+    uint8_t *dists = dist.data();
+    Slot *table = slots;
+    size_t mask = num_slots - 1;
+    for(size_t j = (i + 1) & mask; dists[j] > 1; i = j, j = (j + 1) & mask) {
+        table[i] = std::move(table[j]);
+        dists[i] = dists[j] - 1;
+    }
+    std::destroy_at(&table[i]);
+    dists[i] = DIST_EMPTY;
+    num_elements --;
+    return true;
+}
+
+template <typename K, typename V, typename Hash>
+V* Robin_Hood_Table<K, V, Hash>::find(const K &key) {
+
+    size_t i = find_index(key, hash_of(key));
+    return (i == NPOS) ? (nullptr) : (&slots[i].value);
+}
+
+template <typename K, typename V, typename Hash>
+const V* Robin_Hood_Table<K, V, Hash>::find(const K &key) const {
+
+    size_t i = find_index(key, hash_of(key));
+    return (i == NPOS) ? (nullptr) : (&slots[i].value);
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Robin_Hood_Table<K, V, Hash>::contains(const K &key) const {
+    return find_index(key, hash_of(key)) != NPOS;
+}
+
+template <typename K, typename V, typename Hash>
+void Robin_Hood_Table<K, V, Hash>::reserve(size_t n) {
+
+    // enough slots that n keys stay under the max load
+    if(n == 0)
+        return;
+
+    size_t capacity = std::bit_ceil(static_cast<size_t>(static_cast<double>(n) / max_load) + 1);
+    if(capacity > num_slots)
+        rehash(capacity);
+}
+
+template <typename K, typename V, typename Hash>
+void Robin_Hood_Table<K, V, Hash>::clear() {
+
+    for(size_t i = 0; i < dist.size(); ++i) {
+        if(dist[i] != DIST_EMPTY) std::destroy_at(&slots[i]);
+    }
+    std::fill(dist.begin(), dist.end(), DIST_EMPTY);
+    num_elements = 0;
+}
+
+template <typename K, typename V, typename Hash>
+template <typename Func>
+void Robin_Hood_Table<K, V, Hash>::for_each(Func fn) const {
+
+    for(size_t i = 0; i < dist.size(); ++i) {
+        if(dist[i] != DIST_EMPTY) fn(slots[i].key, slots[i].value);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void Robin_Hood_Table<K, V, Hash>::show(std::ostream &os) const {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Capacity: " << std::setw(4) << capacity() << ", ";
+    os << "Longest probe: " << std::setw(4) << static_cast<int>(dist.empty() ? 0 : *std::max_element(dist.begin(), dist.end())) << std::endl;
+
+    for_each([&os](const K &key, const V &value) {
+        os << key << ": " << value << ", ";
+    });
+    os << std::endl;
+}
+
+template <typename K, typename V, typename Hash>
+inline float Robin_Hood_Table<K, V, Hash>::load_factor() const {
+    return (capacity() == 0) ? (0.0f) : (static_cast<float>(num_elements) / capacity());
+}
+
+template <typename K, typename V, typename Hash>
+inline float Robin_Hood_Table<K, V, Hash>::max_load_factor() const {
+    return max_load;
+}
+
+template <typename K, typename V, typename Hash>
+void Robin_Hood_Table<K, V, Hash>::max_load_factor(float max_load) {
+
+    if(!(max_load > 0.0f && max_load < 1.0f)) {
+        throw std::out_of_range("The max load is out of range");
+    }
+
+    this->max_load = max_load;
+    if(num_elements > load_limit())
+        reserve(num_elements);
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Robin_Hood_Table<K, V, Hash>::empty() const {
+    return (size() == 0);
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Robin_Hood_Table<K, V, Hash>::size() const {
+    return num_elements;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Robin_Hood_Table<K, V, Hash>::capacity() const {
+    return num_slots;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Robin_Hood_Table<K, V, Hash>::hash_of(const K &key) const {
+    return hash_mix(hasher(key));
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Robin_Hood_Table<K, V, Hash>::load_limit() const {
+    // at least one slot stays empty, so every run ends
+    return std::min(capacity() - 1, static_cast<size_t>(capacity() * static_cast<double>(max_load)));
+}
+
+template <typename K, typename V, typename Hash>
+size_t Robin_Hood_Table<K, V, Hash>::find_index(const K &key, size_t h) const {
+
+    if(num_slots == 0)
+        return NPOS;
+
+    // the runs are sorted by home, so an entry with a shorter probe than d means key is absent
+    size_t mask = num_slots - 1;
+    for(size_t i = h & mask, d = 1; ; i = (i + 1) & mask, ++d) {
+        if(dist[i] < d)
+            return NPOS;
+        if(dist[i] == d && slots[i].key == key)
+            return i;
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void Robin_Hood_Table<K, V, Hash>::insert_new(size_t h, Slot &&slot) {
+
+    if(num_slots == 0 || num_elements + 1 > load_limit())
+        rehash(std::max<size_t>(2, 2 * num_slots));
+
+    while(!place(h, slot)) {
+        // a probe this long in a table this sparse means the keys share their hash bits,
+        // and more slots would not shorten it
+        if(8 * num_elements < num_slots) {
+            throw std::runtime_error("The keys collide too often in the Robin_Hood_Table");
+        }
+        rehash(2 * num_slots);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+bool Robin_Hood_Table<K, V, Hash>::place(size_t h, Slot &slot) {
+
+    // the new entry goes before the first entry with a shorter probe, and the rest of the run
+    // moves one slot on; false, with nothing changed, when a probe would reach DIST_LIMIT
+    uint8_t *dists = dist.data();
+    Slot *table = slots;
+    size_t mask = num_slots - 1;
+    size_t i = h & mask, d = 1;
+    for(; dists[i] >= d; i = (i + 1) & mask) {
+        if(++d == DIST_LIMIT)
+            return false;
+    }
+
+    size_t e = i;
+    for(; dists[e] != DIST_EMPTY; e = (e + 1) & mask) {
+        if(dists[e] + 1 == DIST_LIMIT)
+            return false;
+    }
+
+    if(e == i) {
+        std::construct_at(&table[i], std::move(slot));
+    }
+    else {
+        // the empty slot is constructed from the end of the run, the rest moves by assignment
+        size_t prev = (e - 1) & mask;
+        std::construct_at(&table[e], std::move(table[prev]));
+        dists[e] = dists[prev] + 1;
+        for(e = prev; e != i; e = prev) {
+            prev = (e - 1) & mask;
+            table[e] = std::move(table[prev]);
+            dists[e] = dists[prev] + 1;
+        }
+        table[i] = std::move(slot);
+    }
+    dists[i] = static_cast<uint8_t>(d);
+    num_elements ++;
+    return true;
+}
+
+template <typename K, typename V, typename Hash>
+void Robin_Hood_Table<K, V, Hash>::rehash(size_t capacity) {
+
+    std::vector<uint8_t> old_dist = std::exchange(dist, std::vector<uint8_t>(capacity, DIST_EMPTY));
+    Slot *old_slots = std::exchange(slots, std::allocator<Slot>().allocate(capacity));
+    num_slots = capacity;
+    num_elements = 0;
+
+    // a failed place grows again; the old arrays stay local to this call until they are drained
+    for(size_t i = 0; i < old_dist.size(); ++i) {
+        if(old_dist[i] == DIST_EMPTY)
+            continue;
+
+        size_t h = hash_of(old_slots[i].key);
+        while(!place(h, old_slots[i]))
+            rehash(2 * num_slots);
+        std::destroy_at(&old_slots[i]);
+    }
+
+    if(old_slots != nullptr)
+        std::allocator<Slot>().deallocate(old_slots, old_dist.size());
+}
+
+template <typename K, typename V, typename Hash>
+void Robin_Hood_Table<K, V, Hash>::release() {
+
+    if(slots == nullptr)
+        return;
+
+    clear();
+    std::allocator<Slot>().deallocate(slots, capacity());
+    slots = nullptr;
+    dist.clear();
+    num_slots = 0;
+}
+
+}
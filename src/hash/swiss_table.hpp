@@ -0,0 +1,443 @@
+#pragma once
+
+#include "hash_util.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <bit>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Declaration */
+namespace ds_imp {
+
+template <typename K, typename V>
+struct Swiss_Slot {
+    K key;
+    V value;
+};
+
+/*
+ * Open addressing with one control byte per slot: the low 7 bits of the hash for a full slot,
+ * CTRL_EMPTY or CTRL_DELETED otherwise. A probe compares a group of 16 control bytes at once and
+ * only touches the slots whose byte matches; groups are visited in triangular order.
+ */
+template <typename K, typename V, typename Hash = std::hash<K>>
+class Swiss_Table {
+
+    using Slot = Swiss_Slot<K, V>;
+
+    public:
+        Swiss_Table(size_t capacity = 0, float max_load = DEFAULT_MAX_LOAD);
+        ~Swiss_Table();
+
+        Swiss_Table(const Swiss_Table &other) = delete;
+        Swiss_Table& operator=(const Swiss_Table &other) = delete;
+        Swiss_Table(Swiss_Table &&other) noexcept;
+        Swiss_Table& operator=(Swiss_Table &&other) noexcept;
+
+        void insert(const K &key, const V &value);
+        void insert_or_update(const K &key, const V &value);
+        bool erase(const K &key);
+        V* find(const K &key);
+        const V* find(const K &key) const;
+        inline bool contains(const K &key) const;
+        void reserve(size_t n);
+        void clear();
+        template <typename Func>
+        void for_each(Func fn) const;
+        void show(std::ostream &os) const;
+        inline float load_factor() const;
+        inline float max_load_factor() const;
+        void max_load_factor(float max_load);
+        inline bool empty() const;
+        inline size_t size() const;
+        inline size_t capacity() const;
+
+        static constexpr size_t GROUP_WIDTH      = 16;
+        static constexpr float  DEFAULT_MAX_LOAD = 0.875f;
+        static constexpr int8_t CTRL_EMPTY       = -128;
+        static constexpr int8_t CTRL_DELETED     = -2;
+
+    private:
+        std::vector<int8_t> ctrl;     // one byte per slot, capacity() in total
+        Slot *slots;
+        size_t num_groups;            // a power of two, or zero before the first insert
+        size_t num_elements;
+        size_t num_deleted;           // tombstones still counted against the load
+        float max_load;
+        Hash hasher;
+
+        static constexpr size_t NPOS = SIZE_MAX;
+
+        inline size_t hash_of(const K &key) const;
+        inline uint32_t match(size_t group, int8_t h2) const;
+        inline uint32_t match_empty(size_t group) const;
+        inline uint32_t match_free(size_t group) const;
+        inline size_t load_limit() const;
+        size_t find_index(const K &key, size_t h) const;
+        size_t find_free(size_t h) const;
+        void prepare_insert();
+        void rehash(size_t groups);
+        void release();
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+template <typename K, typename V, typename Hash>
+Swiss_Table<K, V, Hash>::Swiss_Table(size_t capacity, float max_load)
+    : slots(nullptr),
+      num_groups(0),
+      num_elements(0),
+      num_deleted(0),
+      max_load(DEFAULT_MAX_LOAD) {
+
+    max_load_factor(max_load);
+    reserve(capacity);
+}
+
+template <typename K, typename V, typename Hash>
+Swiss_Table<K, V, Hash>::~Swiss_Table() {
+    release();
+}
+
+template <typename K, typename V, typename Hash>
+Swiss_Table<K, V, Hash>::Swiss_Table(Swiss_Table &&other) noexcept
+    : ctrl(std::move(other.ctrl)),
+      slots(other.slots),
+      num_groups(other.num_groups),
+      num_elements(other.num_elements),
+      num_deleted(other.num_deleted),
+      max_load(other.max_load),
+      hasher(std::move(other.hasher)) {
+
+    other.ctrl.clear();
+    other.slots = nullptr;
+    other.num_groups = other.num_elements = other.num_deleted = 0;
+}
+
+template <typename K, typename V, typename Hash>
+Swiss_Table<K, V, Hash>& Swiss_Table<K, V, Hash>::operator=(Swiss_Table &&other) noexcept {
+
+    if(this == &other) return *this;
+
+    release();
+    ctrl = std::move(other.ctrl);
+    slots = other.slots;
+    num_groups = other.num_groups;
+    num_elements = other.num_elements;
+    num_deleted = other.num_deleted;
+    max_load = other.max_load;
+    hasher = std::move(other.hasher);
+
+    other.ctrl.clear();
+    other.slots = nullptr;
+    other.num_groups = other.num_elements = other.num_deleted = 0;
+    return *this;
+}
+
+template <typename K, typename V, typename Hash>
+void Swiss_Table<K, V, Hash>::insert(const K &key, const V &value) {
+
+    size_t h = hash_of(key);
+    if(find_index(key, h) != NPOS) {
+        throw std::runtime_error("The key has been in the Swiss_Table");
+    }
+
+    prepare_insert();
+    size_t i = find_free(h);
+    if(ctrl[i] == CTRL_DELETED) num_deleted --;
+
+    ctrl[i] = static_cast<int8_t>(h & 0x7F);
+    std::construct_at(&slots[i], Slot{key, value});
+    num_elements ++;
+}
+
+template <typename K, typename V, typename Hash>
+void Swiss_Table<K, V, Hash>::insert_or_update(const K &key, const V &value) {
+
+    size_t h = hash_of(key), i = find_index(key, h);
+    if(i != NPOS) {
+        slots[i].value = value;
+        return;
+    }
+
+    prepare_insert();
+    i = find_free(h);
+    if(ctrl[i] == CTRL_DELETED) num_deleted --;
+
+    ctrl[i] = static_cast<int8_t>(h & 0x7F);
+    std::construct_at(&slots[i], Slot{key, value});
+    num_elements ++;
+}
+
+template <typename K, typename V, typename Hash>
+bool Swiss_Table<K, V, Hash>::erase(const K &key) {
+
+    size_t i = find_index(key, hash_of(key));
+    if(i == NPOS)
+        return false;
+
+    std::destroy_at(&slots[i]);
+    num_elements --;
+
+    // a probe stops at the first group holding an empty byte, so no probe ever passed this group
+    // if it already has one, and the slot can be empty again instead of a tombstone
+    if(match_empty(i / GROUP_WIDTH) != 0) {
+        ctrl[i] = CTRL_EMPTY;
+    }
+    else {
+        ctrl[i] = CTRL_DELETED;
+        num_deleted ++;
+    }
+    return true;
+}
+
+template <typename K, typename V, typename Hash>
+V* Swiss_Table<K, V, Hash>::find(const K &key) {
+
+    size_t i = find_index(key, hash_of(key));
+    return (i == NPOS) ? (nullptr) : (&slots[i].value);
+}
+
+template <typename K, typename V, typename Hash>
+const V* Swiss_Table<K, V, Hash>::find(const K &key) const {
+
+    size_t i = find_index(key, hash_of(key));
+    return (i == NPOS) ? (nullptr) : (&slots[i].value);
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Swiss_Table<K, V, Hash>::contains(const K &key) const {
+    return find_index(key, hash_of(key)) != NPOS;
+}
+
+template <typename K, typename V, typename Hash>
+void Swiss_Table<K, V, Hash>::reserve(size_t n) {
+
+    // enough groups that n keys stay under the max load
+    if(n == 0)
+        return;
+
+    size_t slots_needed = static_cast<size_t>(static_cast<double>(n) / max_load) + 1;
+    size_t groups = std::bit_ceil((slots_needed + GROUP_WIDTH - 1) / GROUP_WIDTH);
+    if(groups > num_groups)
+        rehash(groups);
+}
+
+template <typename K, typename V, typename Hash>
+void Swiss_Table<K, V, Hash>::clear() {
+
+    for(size_t i = 0; i < ctrl.size(); ++i) {
+        if(ctrl[i] >= 0) std::destroy_at(&slots[i]);
+    }
+    std::fill(ctrl.begin(), ctrl.end(), CTRL_EMPTY);
+    num_elements = num_deleted = 0;
+}
+
+template <typename K, typename V, typename Hash>
+template <typename Func>
+void Swiss_Table<K, V, Hash>::for_each(Func fn) const {
+
+    for(size_t i = 0; i < ctrl.size(); ++i) {
+        if(ctrl[i] >= 0) fn(slots[i].key, slots[i].value);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void Swiss_Table<K, V, Hash>::show(std::ostream &os) const {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Capacity: " << std::setw(4) << capacity() << ", ";
+    os << "Tombstones: " << std::setw(4) << num_deleted << std::endl;
+
+    for_each([&os](const K &key, const V &value) {
+        os << key << ": " << value << ", ";
+    });
+    os << std::endl;
+}
+
+template <typename K, typename V, typename Hash>
+inline float Swiss_Table<K, V, Hash>::load_factor() const {
+    return (capacity() == 0) ? (0.0f) : (static_cast<float>(num_elements) / capacity());
+}
+
+template <typename K, typename V, typename Hash>
+inline float Swiss_Table<K, V, Hash>::max_load_factor() const {
+    return max_load;
+}
+
+template <typename K, typename V, typename Hash>
+void Swiss_Table<K, V, Hash>::max_load_factor(float max_load) {
+
+    if(!(max_load > 0.0f && max_load < 1.0f)) {
+        throw std::out_of_range("The max load is out of range");
+    }
+
+    this->max_load = max_load;
+    if(num_elements + num_deleted > load_limit())
+        reserve(num_elements);
+}
+
+template <typename K, typename V, typename Hash>
+inline bool Swiss_Table<K, V, Hash>::empty() const {
+    return (size() == 0);
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Swiss_Table<K, V, Hash>::size() const {
+    return num_elements;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Swiss_Table<K, V, Hash>::capacity() const {
+    return num_groups * GROUP_WIDTH;
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Swiss_Table<K, V, Hash>::hash_of(const K &key) const {
+    return hash_mix(hasher(key));
+}
+
+template <typename K, typename V, typename Hash>
+inline uint32_t Swiss_Table<K, V, Hash>::match(size_t group, int8_t h2) const {
+
+    // bit j is set when the control byte j of the group equals h2
+    const int8_t *base = ctrl.data() + group * GROUP_WIDTH;
+#if defined(__SSE2__)
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(h2))));
+#else
+    uint32_t mask = 0;
+    for(size_t j = 0; j < GROUP_WIDTH; ++j)
+        mask |= static_cast<uint32_t>(base[j] == h2) << j;
+    return mask;
+#endif
+}
+
+template <typename K, typename V, typename Hash>
+inline uint32_t Swiss_Table<K, V, Hash>::match_empty(size_t group) const {
+    return match(group, CTRL_EMPTY);
+}
+
+template <typename K, typename V, typename Hash>
+inline uint32_t Swiss_Table<K, V, Hash>::match_free(size_t group) const {
+
+    // empty and deleted bytes are the negative ones
+    const int8_t *base = ctrl.data() + group * GROUP_WIDTH;
+#if defined(__SSE2__)
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base));
+    return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+#else
+    uint32_t mask = 0;
+    for(size_t j = 0; j < GROUP_WIDTH; ++j)
+        mask |= static_cast<uint32_t>(base[j] < 0) << j;
+    return mask;
+#endif
+}
+
+template <typename K, typename V, typename Hash>
+inline size_t Swiss_Table<K, V, Hash>::load_limit() const {
+    // at least one slot stays empty, so a probe for an absent key always ends
+    return std::min(capacity() - 1, static_cast<size_t>(capacity() * static_cast<double>(max_load)));
+}
+
+template <typename K, typename V, typename Hash>
+size_t Swiss_Table<K, V, Hash>::find_index(const K &key, size_t h) const {
+
+    if(num_groups == 0)
+        return NPOS;
+
+    int8_t h2 = static_cast<int8_t>(h & 0x7F);
+    size_t group = (h >> 7) & (num_groups - 1);
+
+    for(size_t step = 1; ; ++step) {
+        for(uint32_t mask = match(group, h2); mask != 0; mask &= mask - 1) {
+            size_t i = group * GROUP_WIDTH + std::countr_zero(mask);
+            if(slots[i].key == key)
+                return i;
+        }
+
+        if(match_empty(group) != 0)
+            return NPOS;
+        group = (group + step) & (num_groups - 1);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+size_t Swiss_Table<K, V, Hash>::find_free(size_t h) const {
+
+    // the first empty or deleted slot on the probe sequence of h
+    size_t group = (h >> 7) & (num_groups - 1);
+    for(size_t step = 1; ; ++step) {
+        uint32_t mask = match_free(group);
+        if(mask != 0)
+            return group * GROUP_WIDTH + std::countr_zero(mask);
+        group = (group + step) & (num_groups - 1);
+    }
+}
+
+template <typename K, typename V, typename Hash>
+void Swiss_Table<K, V, Hash>::prepare_insert() {
+
+    // room for one more key; when tombstones fill at least half of the budget,
+    // rebuilding at the same size is enough to reclaim them
+    if(num_groups > 0 && num_elements + num_deleted + 1 <= load_limit())
+        return;
+
+    if(num_groups > 0 && 2 * (num_elements + 1) <= load_limit())
+        rehash(num_groups);
+    else
+        rehash(std::max<size_t>(1, 2 * num_groups));
+}
+
+template <typename K, typename V, typename Hash>
+void Swiss_Table<K, V, Hash>::rehash(size_t groups) {
+
+    std::vector<int8_t> old_ctrl = std::exchange(ctrl, std::vector<int8_t>(groups * GROUP_WIDTH, CTRL_EMPTY));
+    Slot *old_slots = std::exchange(slots, std::allocator<Slot>().allocate(groups * GROUP_WIDTH));
+    size_t old_groups = num_groups;
+    num_groups = groups;
+    num_deleted = 0;
+
+    for(size_t i = 0; i < old_ctrl.size(); ++i) {
+        if(old_ctrl[i] < 0)
+            continue;
+
+        size_t h = hash_of(old_slots[i].key), j = find_free(h);
+        ctrl[j] = static_cast<int8_t>(h & 0x7F);
+        std::construct_at(&slots[j], std::move(old_slots[i]));
+        std::destroy_at(&old_slots[i]);
+    }
+
+    if(old_slots != nullptr)
+        std::allocator<Slot>().deallocate(old_slots, old_groups * GROUP_WIDTH);
+}
+
+template <typename K, typename V, typename Hash>
+void Swiss_Table<K, V, Hash>::release() {
+
+    if(slots == nullptr)
+        return;
+
+    clear();
+    std::allocator<Slot>().deallocate(slots, capacity());
+    slots = nullptr;
+    ctrl.clear();
+    num_groups = 0;
+}
+
+}
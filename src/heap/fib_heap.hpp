@@ -6,6 +6,7 @@
 #include <variant>
 #include <unordered_map>
 #include <set>
+#include <stack>
 #include <fstream>
 #include <iomanip>
 
@@ -23,7 +24,6 @@ FibNode<T>* combine_link(FibNode<T>* node_x, FibNode<T>* node_y);
 
 template <typename T>
 struct FibNode {
-    bool has_show;
     bool marked;
     T element;
     size_t degree;
@@ -74,6 +74,7 @@ class FibHeap {
         ~FibHeap();
 
         Result get_min();
+        void meld(FibHeap<T> &&other);
         void insert_node(const T  &ele);
         void insert_node(T &&ele);
         void delete_min();
@@ -113,7 +114,6 @@ FibNode<T>::FibNode(
 ) : element(ele)  , degree(degree) , num_nodes(num_nodes), 
     parent(parent), children(child) {
     marked    = false;
-    has_show  = false;
     left_sib  = ( left == nullptr) ? (this) : (left);
     right_sib = (right == nullptr) ? (this) : (right);
 }
@@ -130,7 +130,6 @@ FibNode<T>::FibNode(
 ) : element(std::move(ele)), degree(degree) , num_nodes(num_nodes), 
     parent(parent)         , children(child) {
     marked    = false;
-    has_show  = false;
     left_sib  = ( left == nullptr) ? (this) : (left);
     right_sib = (right == nullptr) ? (this) : (right);
 }
@@ -138,10 +137,29 @@ FibNode<T>::FibNode(
 template <typename T>
 FibNode<T>::~FibNode() {
 
+    // iterative destruction
+    // break the circular sibling list, then free the nodes as one chain linked by right_sib
     if(left_sib != nullptr)
         left_sib->right_sib = nullptr;
-    if(right_sib != nullptr) delete right_sib;
-    if(children != nullptr)  delete children;
+
+    FibNode<T> *curr = right_sib, *next = nullptr;
+    if(children != nullptr) {
+        children->left_sib->right_sib = right_sib;
+        curr = children;
+    }
+    left_sib = right_sib = children = nullptr;
+
+    while(curr != nullptr) {
+        next = curr->right_sib;
+        if(curr->children != nullptr) {
+            curr->children->left_sib->right_sib = next;
+            next = curr->children;
+        }
+
+        curr->left_sib = curr->right_sib = curr->children = nullptr;
+        delete curr;
+        curr = next;
+    }
 }
 
 template <typename T>
@@ -168,38 +186,52 @@ FibNode<T>* FibNode<T>::find_min_sibling() {
 template <typename T>
 void FibNode<T>::show(std::ostream &os) {
 
-    if(has_show)
-        return;
+    // preorder over the sibling lists, each stack entry is the first node of a list
+    std::stack<FibNode<T>*> heads;
+    FibNode<T> *curr = this;
+    heads.push(this);
+
+    while(curr != nullptr) {
 
-    os << "Parent: ";
-    if (!parent) os << "null";
-    else         os << std::left << std::setw(4) << parent->element;
-    os << ", ";
+        os << "Parent: ";
+        if (!curr->parent) os << "null";
+        else               os << std::left << std::setw(4) << curr->parent->element;
+        os << ", ";
 
-    os << "Node("   << degree << "): "
-       << std::left << std::setw(4) << element << ", ";
+        os << "Node("   << curr->degree << "): "
+           << std::left << std::setw(4) << curr->element << ", ";
 
-    os << "Left: ";
-    if (!left_sib) os << "null";
-    else           os << std::left << std::setw(4) << left_sib->element;
-    os << ", ";
+        os << "Left: ";
+        if (!curr->left_sib) os << "null";
+        else                 os << std::left << std::setw(4) << curr->left_sib->element;
+        os << ", ";
 
-    os << "Right: ";
-    if (!right_sib) os << "null";
-    else            os << std::left << std::setw(4) << right_sib->element;
-    os << ", ";
+        os << "Right: ";
+        if (!curr->right_sib) os << "null";
+        else                  os << std::left << std::setw(4) << curr->right_sib->element;
+        os << ", ";
 
-    os << "Children: ";
-    if (!children)  os << "null";
-    else            os << std::left << std::setw(4) << children->element;
-    os << ", ";
+        os << "Children: ";
+        if (!curr->children)  os << "null";
+        else                  os << std::left << std::setw(4) << curr->children->element;
+        os << ", ";
 
-    os << "Marked: " << marked << std::endl;
+        os << "Marked: " << curr->marked << std::endl;
 
-    has_show = true;
-    if (children)  children->show(os);
-    if (right_sib) right_sib->show(os);
-    has_show = false;
+        if(curr->children != nullptr) {
+            heads.push(curr->children);
+            curr = curr->children;
+            continue;
+        }
+
+        // go back to the parent list once a sibling list has been walked around
+        curr = curr->right_sib;
+        while(!heads.empty() && (curr == nullptr || curr == heads.top())) {
+            curr = heads.top()->parent;
+            heads.pop();
+            curr = (heads.empty() || curr == nullptr) ? (nullptr) : (curr->right_sib);
+        }
+    }
 
     return;
 }
@@ -296,6 +328,27 @@ FibHeap<T>::Result FibHeap<T>::get_min() {
     return root->element;
 }
 
+template <typename T>
+void FibHeap<T>::meld(FibHeap<T> &&other) {
+
+    if(this == &other || other.empty())
+        return;
+
+    root = combine_link(root, other.root);
+    num_nodes += other.num_nodes;
+
+    // move the node sets bucket by bucket, the nodes are relinked instead of rehashed
+    if(hash_table.size() < other.hash_table.size())
+        hash_table.swap(other.hash_table);
+    for(auto &p: other.hash_table) 
+        hash_table[p.first].merge(p.second);
+
+    other.hash_table.clear();
+    other.root = nullptr;
+    other.num_nodes = 0;
+    return;
+}
+
 template <typename T>
 void FibHeap<T>::insert_node(const T  &ele) {
 
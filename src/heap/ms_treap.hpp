@@ -7,7 +7,9 @@
 #include <utility>
 #include <fstream>
 #include <variant>
+#include <stack>
 #include <random>
+#include "../utils.hpp"
 
 /* Declaration */ 
 /* Merge-split Treap */
@@ -24,7 +26,19 @@ MS_TreapNode<T>* merge(MS_TreapNode<T>* node_left, MS_TreapNode<T>* node_right);
 
 template <typename T>
 Split_Result<T> split(MS_TreapNode<T>* node_x, const T ele, bool in_first);
+
+template <typename T>
+MS_TreapNode<T>* union_nodes(MS_TreapNode<T>* node_x, MS_TreapNode<T>* node_y, size_t depth, size_t &freed);
+
+template <typename T>
+MS_TreapNode<T>* intersect_nodes(MS_TreapNode<T>* node_x, MS_TreapNode<T>* node_y, size_t depth, size_t &freed);
+
+template <typename T>
+MS_TreapNode<T>* difference_nodes(MS_TreapNode<T>* node_x, MS_TreapNode<T>* node_y, size_t depth, size_t &freed);
     
+template <typename T>
+bool fork_here(MS_TreapNode<T>* node_x, MS_TreapNode<T>* node_y, size_t depth);
+
 template <typename T>
 struct MS_TreapNode {
 
@@ -40,6 +54,9 @@ struct MS_TreapNode {
     /* Destructor */
     ~MS_TreapNode();
 
+    static size_t release(MS_TreapNode<T>* node);
+    static size_t count_nodes(MS_TreapNode<T>* node, size_t limit);
+
     void inorder(std::ostream &os);
 
     friend MS_TreapNode<T>* merge<T>(MS_TreapNode<T>* node_left, MS_TreapNode<T>* node_right);
@@ -57,10 +74,15 @@ class MS_Treap {
         void insert_node(T &&ele);
         void erase_node(const T ele);
         bool find_node(const T ele);
+        void set_union(MS_Treap<T> &&other);
+        void set_intersection(MS_Treap<T> &&other);
+        void set_difference(MS_Treap<T> &&other);
         void inorder(std::ostream &os);
         inline bool empty() const;
         inline size_t size() const;
 
+        static const size_t PARALLEL_GRAIN = 4096;
+
     private:
         MS_TreapNode<T> *root;
         size_t num_nodes;
@@ -84,16 +106,81 @@ MS_TreapNode<T>::MS_TreapNode(uint32_t priority, T &&ele, MS_TreapNode<T>* left,
 template <typename T>
 MS_TreapNode<T>::~MS_TreapNode() {
     
-    if( left != nullptr)  delete left;
-    if(right != nullptr)  delete right;
+    // iterative destruction
+    release(left);
+    release(right);
+}
+
+template <typename T>
+size_t MS_TreapNode<T>::release(MS_TreapNode<T>* node) {
+
+    // rotate left children up until the subtree becomes a right chain, then free the chain
+    MS_TreapNode<T> *temp = nullptr;
+    size_t count = 0;
+    while(node != nullptr) {
+        if(node->left != nullptr) {
+            temp = node->left;
+            node->left = temp->right;
+            temp->right = node;
+            node = temp;
+        }
+        else {
+            temp = node->right;
+            node->right = nullptr;
+            delete node;
+            count ++;
+            node = temp;
+        }
+    }
+    return count;
+}
+
+template <typename T>
+size_t MS_TreapNode<T>::count_nodes(MS_TreapNode<T>* node, size_t limit) {
+
+    // the nodes keep no subtree sizes, so walk the subtree and stop after limit nodes
+    std::stack<MS_TreapNode<T>*> nodes;
+    size_t count = 0;
+    if(node != nullptr) nodes.push(node);
+
+    while(!nodes.empty() && count < limit) {
+        MS_TreapNode<T> *curr = nodes.top();
+        nodes.pop();
+        count ++;
+        if(curr->left  != nullptr) nodes.push(curr->left);
+        if(curr->right != nullptr) nodes.push(curr->right);
+    }
+    return count;
+}
+
+template <typename T>
+bool fork_here(MS_TreapNode<T>* node_x, MS_TreapNode<T>* node_y, size_t depth) {
+
+    // fork only while the two subtrees hold PARALLEL_GRAIN nodes, each check walks at most that many
+    const size_t grain = MS_Treap<T>::PARALLEL_GRAIN;
+    if(depth == 0)
+        return false;
+    size_t count = MS_TreapNode<T>::count_nodes(node_x, grain);
+    return (count + MS_TreapNode<T>::count_nodes(node_y, grain - count) >= grain);
 }
 
 template <typename T>
 void MS_TreapNode<T>::inorder(std::ostream &os) {
 
-    if( left != nullptr) left->inorder(os);
-    os << element << ", ";
-    if(right != nullptr) right->inorder(os);
+    std::stack<MS_TreapNode<T>*> nodes;
+    decltype(this) curr = this;
+
+    while(curr != nullptr || !nodes.empty()) {
+        while(curr != nullptr) {
+            nodes.push(curr);
+            curr = curr->left;
+        }
+
+        curr = nodes.top();
+        nodes.pop();
+        os << curr->element << ", ";
+        curr = curr->right;
+    }
 }
 
 template <typename T>
@@ -139,6 +226,107 @@ Split_Result<T> split(MS_TreapNode<T>* node_x, const T ele, bool in_first) {
     }
 }
 
+template <typename T>
+MS_TreapNode<T>* union_nodes(MS_TreapNode<T>* node_x, MS_TreapNode<T>* node_y, size_t depth, size_t &freed) {
+
+    if(node_x == nullptr) return node_y;
+    if(node_y == nullptr) return node_x;
+
+    // a pair too small to fork stops the checks below it as well
+    size_t fork = (fork_here<T>(node_x, node_y, depth)) ? (depth) : (0);
+
+    // the root with the higher priority (smaller value) stays on top
+    if(node_y->priority < node_x->priority)
+        std::swap(node_x, node_y);
+
+    auto node_less  = split<T>(node_y, node_x->element, false);
+    auto node_equal = split<T>(node_less.second, node_x->element, true);
+    freed += MS_TreapNode<T>::release(node_equal.first);
+
+    size_t freed_left = 0, freed_right = 0, next = (fork > 0) ? (fork - 1) : (0);
+    fork_join(fork,
+        [&] { node_x->left  = union_nodes<T>(node_x->left , node_less.first  , next, freed_left ); },
+        [&] { node_x->right = union_nodes<T>(node_x->right, node_equal.second, next, freed_right); }
+    );
+
+    freed += freed_left + freed_right;
+    return node_x;
+}
+
+template <typename T>
+MS_TreapNode<T>* intersect_nodes(MS_TreapNode<T>* node_x, MS_TreapNode<T>* node_y, size_t depth, size_t &freed) {
+
+    if(node_x == nullptr || node_y == nullptr) {
+        freed += MS_TreapNode<T>::release(node_x);
+        freed += MS_TreapNode<T>::release(node_y);
+        return nullptr;
+    }
+
+    size_t fork = (fork_here<T>(node_x, node_y, depth)) ? (depth) : (0);
+    if(node_y->priority < node_x->priority)
+        std::swap(node_x, node_y);
+
+    auto node_less  = split<T>(node_y, node_x->element, false);
+    auto node_equal = split<T>(node_less.second, node_x->element, true);
+
+    MS_TreapNode<T> *left = node_x->left, *right = node_x->right;
+    node_x->left = node_x->right = nullptr;
+
+    size_t freed_left = 0, freed_right = 0, next = (fork > 0) ? (fork - 1) : (0);
+    fork_join(fork,
+        [&] { left  = intersect_nodes<T>(left , node_less.first  , next, freed_left ); },
+        [&] { right = intersect_nodes<T>(right, node_equal.second, next, freed_right); }
+    );
+    freed += freed_left + freed_right;
+
+    if(node_equal.first != nullptr) {
+        freed += MS_TreapNode<T>::release(node_equal.first);
+        node_x->left  = left;
+        node_x->right = right;
+        return node_x;
+    }
+
+    delete node_x;
+    freed ++;
+    return merge<T>(left, right);
+}
+
+template <typename T>
+MS_TreapNode<T>* difference_nodes(MS_TreapNode<T>* node_x, MS_TreapNode<T>* node_y, size_t depth, size_t &freed) {
+
+    // the elements of node_x that are not in node_y
+    if(node_x == nullptr) {
+        freed += MS_TreapNode<T>::release(node_y);
+        return nullptr;
+    }
+    if(node_y == nullptr) return node_x;
+
+    size_t fork = (fork_here<T>(node_x, node_y, depth)) ? (depth) : (0);
+    auto node_less  = split<T>(node_y, node_x->element, false);
+    auto node_equal = split<T>(node_less.second, node_x->element, true);
+
+    MS_TreapNode<T> *left = node_x->left, *right = node_x->right;
+    node_x->left = node_x->right = nullptr;
+
+    size_t freed_left = 0, freed_right = 0, next = (fork > 0) ? (fork - 1) : (0);
+    fork_join(fork,
+        [&] { left  = difference_nodes<T>(left , node_less.first  , next, freed_left ); },
+        [&] { right = difference_nodes<T>(right, node_equal.second, next, freed_right); }
+    );
+    freed += freed_left + freed_right;
+
+    if(node_equal.first != nullptr) {
+        freed += MS_TreapNode<T>::release(node_equal.first);
+        delete node_x;
+        freed ++;
+        return merge<T>(left, right);
+    }
+
+    node_x->left  = left;
+    node_x->right = right;
+    return node_x;
+}
+
 /* MS_Treap */
 template <typename T>
 MS_Treap<T>::MS_Treap()
@@ -163,9 +351,10 @@ void MS_Treap<T>::insert_node(const T  &ele) {
 
     std::uniform_int_distribution<uint32_t> dist(0, UINT32_MAX);
 
-    auto res = split<T>(root, ele);
+    auto res = split<T>(root, ele, true);
     MS_TreapNode<T>* new_node = new MS_TreapNode<T>(dist(generator), ele);
-    return merge<T>(merge<T>(res.first, new_node), res.second);
+    root = merge<T>(merge<T>(res.first, new_node), res.second);
+    num_nodes ++;
 }
 
 template <typename T>
@@ -176,6 +365,7 @@ void MS_Treap<T>::insert_node(T &&ele) {
     auto res = split<T>(root, ele, true);
     MS_TreapNode<T>* new_node = new MS_TreapNode<T>(dist(generator), std::move(ele));
     root = merge<T>(merge<T>(res.first, new_node), res.second);
+    num_nodes ++;
 }
 
 template <typename T>
@@ -184,6 +374,50 @@ void MS_Treap<T>::erase_node(const T ele) {
     auto node_first = split<T>(root, ele, true);
     auto node_second = split<T>(node_first.first, ele, false);
     root = merge<T>(node_second.first, node_first.second);
+    num_nodes -= MS_TreapNode<T>::release(node_second.second);
+}
+
+template <typename T>
+void MS_Treap<T>::set_union(MS_Treap<T> &&other) {
+
+    if(this == &other)
+        return;
+
+    size_t freed = 0;
+    root = union_nodes<T>(root, other.root, fork_depth(), freed);
+    num_nodes = num_nodes + other.num_nodes - freed;
+    other.root = nullptr;
+    other.num_nodes = 0;
+}
+
+template <typename T>
+void MS_Treap<T>::set_intersection(MS_Treap<T> &&other) {
+
+    if(this == &other)
+        return;
+
+    size_t freed = 0;
+    root = intersect_nodes<T>(root, other.root, fork_depth(), freed);
+    num_nodes = num_nodes + other.num_nodes - freed;
+    other.root = nullptr;
+    other.num_nodes = 0;
+}
+
+template <typename T>
+void MS_Treap<T>::set_difference(MS_Treap<T> &&other) {
+
+    if(this == &other) {
+        MS_TreapNode<T>::release(root);
+        root = nullptr;
+        num_nodes = 0;
+        return;
+    }
+
+    size_t freed = 0;
+    root = difference_nodes<T>(root, other.root, fork_depth(), freed);
+    num_nodes = num_nodes + other.num_nodes - freed;
+    other.root = nullptr;
+    other.num_nodes = 0;
 }
 
 template <typename T>
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "../hash/hash_util.hpp"
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <memory>
+#include <atomic>
+
+/* Declaration */
+namespace ds_imp {
+
+/*
+ * Union-find shared between threads without locks. A root is its own parent; every other
+ * member points closer to its root. Linking a root is a CAS, so two threads never both link the
+ * same root. Roots are linked by a fixed random priority, the mixed hash of the index, which keeps
+ * trees O(log n) deep in expectation without storing ranks. find_root compresses by path halving.
+ */
+class Concurrent_DSU {
+
+    public:
+        Concurrent_DSU() = delete;
+        Concurrent_DSU(uint32_t num_members);
+        ~Concurrent_DSU() = default;
+
+        Concurrent_DSU(const Concurrent_DSU &other) = delete;
+        Concurrent_DSU& operator=(const Concurrent_DSU &other) = delete;
+
+        uint32_t find_root(uint32_t index);
+        void union_root(uint32_t index_a, uint32_t index_b);
+        bool is_same(uint32_t index_a, uint32_t index_b);
+
+        uint32_t get_clusters_num() const;
+        uint32_t get_members_num() const;
+
+        static const uint32_t MAX_MEMBERS_NUM = static_cast<uint32_t>(1e9);
+
+    private:
+        std::unique_ptr<std::atomic<uint32_t>[]> parent;
+        std::atomic<uint32_t> num_clusters;
+        uint32_t num_members;
+
+        uint32_t root_of(uint32_t index);
+        static inline bool links_below(uint32_t root_a, uint32_t root_b);
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+inline Concurrent_DSU::Concurrent_DSU(uint32_t num_members) {
+
+    if(num_members == 0 || num_members > MAX_MEMBERS_NUM) {
+        throw std::out_of_range("The number of members is out of range");
+    }
+
+    this->parent = std::make_unique<std::atomic<uint32_t>[]>(num_members);
+    this->num_members = num_members;
+    this->num_clusters.store(num_members, std::memory_order_relaxed);
+
+    for(uint32_t i = 0; i < num_members; ++i)
+        (this->parent)[i].store(i, std::memory_order_relaxed);
+}
+
+inline uint32_t Concurrent_DSU::find_root(uint32_t index) {
+
+    if(index >= this->num_members)
+        throw std::out_of_range("The index is out of range");
+
+    return root_of(index);
+}
+
+inline void Concurrent_DSU::union_root(uint32_t index_a, uint32_t index_b) {
+
+    if(index_a >= this->num_members || index_b >= this->num_members)
+        throw std::out_of_range("The index is out of range");
+
+    // the CAS only succeeds while the lower root is still a root; otherwise another thread
+    // linked it first, and the walk starts again from the two old roots
+    while(true) {
+        uint32_t root_a = root_of(index_a);
+        uint32_t root_b = root_of(index_b);
+        if(root_a == root_b)
+            return;
+
+        if(links_below(root_b, root_a))
+            std::swap(root_a, root_b);
+
+        uint32_t expected = root_a;
+        if(parent[root_a].compare_exchange_strong(expected, root_b, std::memory_order_acq_rel)) {
+            num_clusters.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+        index_a = root_a;
+        index_b = root_b;
+    }
+}
+
+inline bool Concurrent_DSU::is_same(uint32_t index_a, uint32_t index_b) {
+
+    if(index_a >= this->num_members || index_b >= this->num_members)
+        throw std::out_of_range("The index is out of range");
+
+    // two different roots only prove different sets if the first is still a root after the
+    // second was found; then both were roots at that moment
+    while(true) {
+        uint32_t root_a = root_of(index_a);
+        uint32_t root_b = root_of(index_b);
+        if(root_a == root_b)
+            return true;
+        if(parent[root_a].load(std::memory_order_acquire) == root_a)
+            return false;
+
+        index_a = root_a;
+        index_b = root_b;
+    }
+}
+
+inline uint32_t Concurrent_DSU::get_clusters_num() const {
+    return this->num_clusters.load(std::memory_order_relaxed);
+}
+
+inline uint32_t Concurrent_DSU::get_members_num() const {
+    return this->num_members;
+}
+
+inline uint32_t Concurrent_DSU::root_of(uint32_t index) {
+
+    // path halving: each visited member is swung to its grandparent. A member that is not a
+    // root never becomes one again and only union_root writes roots, so a plain store is enough:
+    // racing halvings can only write different ancestors, and any ancestor keeps the forest valid
+    while(true) {
+        uint32_t next = parent[index].load(std::memory_order_acquire);
+        if(next == index)
+            return index;
+
+        uint32_t grand = parent[next].load(std::memory_order_acquire);
+        if(grand != next)
+            parent[index].store(grand, std::memory_order_release);
+        index = grand;
+    }
+}
+
+inline bool Concurrent_DSU::links_below(uint32_t root_a, uint32_t root_b) {
+
+    // a total order independent of the input: the hash first, the index to break ties
+    size_t priority_a = hash_mix(root_a), priority_b = hash_mix(root_b);
+    return (priority_a < priority_b) || (priority_a == priority_b && root_a < root_b);
+}
+
+}
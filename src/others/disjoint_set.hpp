@@ -67,11 +67,15 @@ namespace ds_imp {
         if(index >= this->num_members)
             throw std::out_of_range("The index is out of range");
 
-        if(this->parent[index] < 0)
-            return index;
-
-        uint32_t root = this->find_root(parent[index]);
-        return parent[index] = root;
+        // path halving: each visited member is pointed at its grandparent on the way up,
+        // so the walk needs no recursion and later walks along the path take half the steps
+        while(this->parent[index] >= 0) {
+            int32_t next = this->parent[index];
+            if(this->parent[next] >= 0)
+                this->parent[index] = this->parent[next];
+            index = this->parent[index];
+        }
+        return index;
     }
 
     void DSU::union_root(uint32_t index_a, uint32_t index_b) {
@@ -82,8 +86,9 @@ namespace ds_imp {
         if(root_a == root_b)
             return;
 
-        int16_t rank_a = (-1) * (this->parent[root_a]);
-        int16_t rank_b = (-1) * (this->parent[root_b]);
+        // a root stores minus its size or height, which fits in int32_t up to MAX_MEMBERS_NUM
+        int32_t rank_a = (-1) * (this->parent[root_a]);
+        int32_t rank_b = (-1) * (this->parent[root_b]);
         
         switch(this->rule) {
             case DSU_Rule::WEIGHT_RULE:
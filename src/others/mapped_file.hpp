@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Declaration */
+namespace ds_imp {
+
+/* A read-only file mapped into memory */
+class Mapped_File {
+
+    public:
+        explicit Mapped_File(const std::string &path);
+        ~Mapped_File();
+
+        Mapped_File(const Mapped_File &other) = delete;
+        Mapped_File& operator=(const Mapped_File &other) = delete;
+        Mapped_File(Mapped_File &&other) noexcept;
+        Mapped_File& operator=(Mapped_File &&other) noexcept;
+
+        inline std::string_view view() const;
+        inline size_t size() const;
+
+    private:
+        const char *data;
+        size_t length;
+
+        void unmap();
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+/* Mapped_File */
+inline Mapped_File::Mapped_File(const std::string &path) : data(nullptr), length(0) {
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+        throw std::runtime_error("Cannot open the mapped file");
+    }
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat the mapped file");
+    }
+
+    length = static_cast<size_t>(st.st_size);
+    if(length > 0) {
+        void *addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map the file");
+        }
+        data = static_cast<const char*>(addr);
+    }
+    ::close(fd);
+}
+
+inline Mapped_File::~Mapped_File() {
+    unmap();
+}
+
+inline Mapped_File::Mapped_File(Mapped_File &&other) noexcept
+    : data(other.data),
+      length(other.length) {
+
+    other.data = nullptr;
+    other.length = 0;
+}
+
+inline Mapped_File& Mapped_File::operator=(Mapped_File &&other) noexcept {
+
+    if(this == &other) return *this;
+
+    unmap();
+    data = other.data;
+    length = other.length;
+    other.data = nullptr;
+    other.length = 0;
+    return *this;
+}
+
+inline std::string_view Mapped_File::view() const {
+    return std::string_view(data, length);
+}
+
+inline size_t Mapped_File::size() const {
+    return length;
+}
+
+inline void Mapped_File::unmap() {
+
+    if(data != nullptr)
+        ::munmap(const_cast<char*>(data), length);
+    data = nullptr;
+    length = 0;
+}
+
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <new>
+#include <memory>
+#include <utility>
+#include <algorithm>
+
+/* Declaration */
+namespace ds_imp {
+
+/*
+ * Fixed-size object pool: nodes are carved from blocks of BLOCK_NODES and recycled through an
+ * intrusive free list, so allocating and freeing a node are O(1) without touching the heap.
+ */
+template <typename T>
+class Node_Pool {
+
+    union Pool_Slot {
+        Pool_Slot *next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    struct Pool_Block {
+        Pool_Block *next;     // BLOCK_NODES slots follow the header at SLOTS_OFFSET
+    };
+
+    public:
+        Node_Pool();
+        ~Node_Pool();
+
+        Node_Pool(const Node_Pool &other) = delete;
+        Node_Pool& operator=(const Node_Pool &other) = delete;
+        Node_Pool(Node_Pool &&other) noexcept;
+        Node_Pool& operator=(Node_Pool &&other) noexcept;
+
+        template <typename... Args>
+        T* create(Args&&... args);
+        void destroy(T *node);
+        void release_all();
+        inline size_t size() const;
+
+        static constexpr size_t BLOCK_NODES = 1024;
+
+    private:
+        static constexpr size_t BLOCK_ALIGN  = std::max(alignof(Pool_Block), alignof(Pool_Slot));
+        static constexpr size_t SLOTS_OFFSET = (sizeof(Pool_Block) + alignof(Pool_Slot) - 1) / alignof(Pool_Slot) * alignof(Pool_Slot);
+
+        Pool_Block *blocks;
+        Pool_Slot *free_list;
+        Pool_Slot *cursor;    // the next never-used slot of the newest block
+        Pool_Slot *limit;
+        size_t num_live;
+
+        Pool_Slot* take();
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+template <typename T>
+Node_Pool<T>::Node_Pool()
+    : blocks(nullptr),
+      free_list(nullptr),
+      cursor(nullptr),
+      limit(nullptr),
+      num_live(0) {}
+
+template <typename T>
+Node_Pool<T>::~Node_Pool() {
+    release_all();
+}
+
+template <typename T>
+Node_Pool<T>::Node_Pool(Node_Pool &&other) noexcept
+    : blocks(std::exchange(other.blocks, nullptr)),
+      free_list(std::exchange(other.free_list, nullptr)),
+      cursor(std::exchange(other.cursor, nullptr)),
+      limit(std::exchange(other.limit, nullptr)),
+      num_live(std::exchange(other.num_live, 0)) {}
+
+template <typename T>
+Node_Pool<T>& Node_Pool<T>::operator=(Node_Pool &&other) noexcept {
+
+    if(this == &other) return *this;
+
+    release_all();
+    blocks = std::exchange(other.blocks, nullptr);
+    free_list = std::exchange(other.free_list, nullptr);
+    cursor = std::exchange(other.cursor, nullptr);
+    limit = std::exchange(other.limit, nullptr);
+    num_live = std::exchange(other.num_live, 0);
+    return *this;
+}
+
+template <typename T>
+template <typename... Args>
+T* Node_Pool<T>::create(Args&&... args) {
+
+    Pool_Slot *slot = take();
+    try {
+        T *node = ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+        num_live ++;
+        return node;
+    }
+    catch(...) {
+        slot->next = free_list;
+        free_list = slot;
+        throw;
+    }
+}
+
+template <typename T>
+void Node_Pool<T>::destroy(T *node) {
+
+    if(node == nullptr)
+        return;
+
+    std::destroy_at(node);
+    Pool_Slot *slot = reinterpret_cast<Pool_Slot*>(node);
+    slot->next = free_list;
+    free_list = slot;
+    num_live --;
+}
+
+template <typename T>
+void Node_Pool<T>::release_all() {
+
+    // O(blocks): the memory of every node goes back at once and no destructor runs,
+    // so an owner with non-trivial nodes destroys them before calling this
+    while(blocks != nullptr) {
+        Pool_Block *next = blocks->next;
+        ::operator delete(static_cast<void*>(blocks), std::align_val_t(BLOCK_ALIGN));
+        blocks = next;
+    }
+    free_list = cursor = limit = nullptr;
+    num_live = 0;
+}
+
+template <typename T>
+inline size_t Node_Pool<T>::size() const {
+    return num_live;
+}
+
+template <typename T>
+Node_Pool<T>::Pool_Slot* Node_Pool<T>::take() {
+
+    if(free_list != nullptr) {
+        Pool_Slot *slot = free_list;
+        free_list = slot->next;
+        return slot;
+    }
+
+    if(cursor == limit) {
+        void *raw = ::operator new(SLOTS_OFFSET + BLOCK_NODES * sizeof(Pool_Slot), std::align_val_t(BLOCK_ALIGN));
+        Pool_Block *block = ::new (raw) Pool_Block{blocks};
+        blocks = block;
+        cursor = reinterpret_cast<Pool_Slot*>(static_cast<std::byte*>(raw) + SLOTS_OFFSET);
+        limit = cursor + BLOCK_NODES;
+    }
+    return cursor ++;
+}
+
+}
@@ -0,0 +1,832 @@
+#pragma once
+
+#include "../element.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <stack>
+#include <bit>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Declaration */
+/* Adaptive radix tree: a byte-wise trie whose inner nodes grow through 4, 16, 48 and 256 slots */
+namespace ds_imp {
+
+/* Keys as bytes whose memcmp order is the key order */
+inline std::string art_key(const Element &ele) {
+
+    // big-endian with the sign bit flipped, so negative values come first
+    uint32_t bits = static_cast<uint32_t>(ele.get()) ^ 0x80000000u;
+    std::string bytes(4, '\0');
+    for(size_t i = 0; i < 4; ++i)
+        bytes[i] = static_cast<char>(bits >> (24 - 8 * i));
+    return bytes;
+}
+
+inline std::string art_key(const std::string &str) {
+    return str;
+}
+
+enum class Art_Type : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+template <typename K>
+struct Art_Node {
+    Art_Type type;
+
+    Art_Node(Art_Type type) : type(type) {}
+};
+
+template <typename K>
+struct Art_Leaf : Art_Node<K> {
+    K key;
+    std::string bytes;
+
+    Art_Leaf(const K &key) : Art_Node<K>(Art_Type::LEAF), key(key), bytes(art_key(key)) {}
+};
+
+template <typename K>
+struct Art_Inner : Art_Node<K> {
+    uint16_t num_children;
+    std::string prefix;       // the compressed path below the byte that led here
+    Art_Leaf<K> *terminal;    // the key that ends exactly at this node
+
+    Art_Inner(Art_Type type) : Art_Node<K>(type), num_children(0), terminal(nullptr) {}
+};
+
+template <typename K>
+struct Art_Node4 : Art_Inner<K> {
+    uint8_t keys[4];
+    Art_Node<K> *children[4];  // sorted by keys
+
+    Art_Node4() : Art_Inner<K>(Art_Type::NODE4) {}
+};
+
+template <typename K>
+struct Art_Node16 : Art_Inner<K> {
+    uint8_t keys[16];
+    Art_Node<K> *children[16];  // sorted by keys
+
+    Art_Node16() : Art_Inner<K>(Art_Type::NODE16) {}
+};
+
+template <typename K>
+struct Art_Node48 : Art_Inner<K> {
+    uint8_t index[256];       // 0 is empty, otherwise the slot in children plus one
+    Art_Node<K> *children[48];
+
+    Art_Node48() : Art_Inner<K>(Art_Type::NODE48) { std::memset(index, 0, sizeof(index)); }
+};
+
+template <typename K>
+struct Art_Node256 : Art_Inner<K> {
+    Art_Node<K> *children[256];
+
+    Art_Node256() : Art_Inner<K>(Art_Type::NODE256) { std::fill(children, children + 256, nullptr); }
+};
+
+template <typename K>
+class Art_Tree {
+
+    using Node = Art_Node<K>;
+    using Leaf = Art_Leaf<K>;
+    using Inner = Art_Inner<K>;
+    using Result = std::variant<std::nullptr_t, K>;
+
+    public:
+        Art_Tree();
+        ~Art_Tree();
+
+        Art_Tree(const Art_Tree<K> &other) = delete;
+        Art_Tree<K>& operator=(const Art_Tree<K> &other) = delete;
+
+        Result get_min() const;
+        Result get_max() const;
+        Result search_node(const K &key) const;
+        void insert_node(const K &key);
+        void delete_node(const K key);
+        void modify_node(const K &key, const K &new_key);
+        template <typename Func>
+        void for_each_with_prefix(const std::string &prefix, Func fn) const;
+        template <typename Func>
+        void for_each_in_range(const K &lo, const K &hi, Func fn) const;
+        void inorder(std::ostream &os) const;
+        void show(std::ostream &os) const;
+        inline bool empty() const;
+        inline size_t size() const;
+
+    private:
+        Node *root;
+        size_t num_nodes;
+
+        static Node** find_child(Inner* node, uint8_t byte);
+        static void add_child(Node** slot, uint8_t byte, Node* child);
+        static void remove_child(Node** slot, uint8_t byte);
+        static void shrink(Node** slot);
+        static Node* next_child(const Inner* node, size_t &pos, uint8_t &byte);
+        static void free_node(Node* node);
+        static void release(Node* node);
+        template <typename Func>
+        static bool walk(const Node* node, std::string &path, const std::string* lo, const std::string* hi, bool hi_is_prefix, Func &fn);
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+template <typename K>
+Art_Tree<K>::Art_Tree()
+    : root(nullptr),
+      num_nodes(0) {}
+
+template <typename K>
+Art_Tree<K>::~Art_Tree() {
+    release(root);
+}
+
+template <typename K>
+Art_Tree<K>::Result Art_Tree<K>::get_min() const {
+
+    Result result = nullptr;
+    std::string path;
+    auto take = [&](const K &key) { result = key; return false; };
+    if(root != nullptr)
+        walk(root, path, nullptr, nullptr, false, take);
+    return result;
+}
+
+template <typename K>
+Art_Tree<K>::Result Art_Tree<K>::get_max() const {
+
+    // the largest child at every level; a terminal is smaller than any child
+    const Node *node = root;
+    while(node != nullptr && node->type != Art_Type::LEAF) {
+        const Inner *inner = static_cast<const Inner*>(node);
+        const Node *last = nullptr;
+        uint8_t byte = 0;
+
+        for(size_t pos = 0; const Node *child = next_child(inner, pos, byte); )
+            last = child;
+        node = (last != nullptr) ? (last) : (inner->terminal);
+    }
+
+    if(node == nullptr)
+        return nullptr;
+    return static_cast<const Leaf*>(node)->key;
+}
+
+template <typename K>
+Art_Tree<K>::Result Art_Tree<K>::search_node(const K &key) const {
+
+    std::string bytes = art_key(key);
+    const Node *node = root;
+    size_t depth = 0;
+
+    while(node != nullptr) {
+        if(node->type == Art_Type::LEAF) {
+            const Leaf *leaf = static_cast<const Leaf*>(node);
+            if(leaf->bytes == bytes) return leaf->key;
+            return nullptr;
+        }
+
+        Inner *inner = const_cast<Inner*>(static_cast<const Inner*>(node));
+        if(bytes.compare(depth, inner->prefix.size(), inner->prefix) != 0)
+            return nullptr;
+        depth += inner->prefix.size();
+
+        if(depth == bytes.size()) {
+            if(inner->terminal != nullptr) return inner->terminal->key;
+            return nullptr;
+        }
+
+        Node **slot = find_child(inner, static_cast<uint8_t>(bytes[depth]));
+        node = (slot != nullptr) ? (*slot) : (nullptr);
+        depth ++;
+    }
+    return nullptr;
+}
+
+template <typename K>
+void Art_Tree<K>::insert_node(const K &key) {
+
+    Leaf *leaf = new Leaf(key);
+    const std::string &bytes = leaf->bytes;
+    Node **slot = &root;
+    size_t depth = 0;
+
+    while(true) {
+        Node *node = *slot;
+        if(node == nullptr) {
+            *slot = leaf;
+            break;
+        }
+
+        if(node->type == Art_Type::LEAF) {
+            // two leaves share a path: a Node4 holds their common bytes
+            Leaf *other = static_cast<Leaf*>(node);
+            if(other->bytes == bytes) {
+                delete leaf;
+                throw std::runtime_error("The element has been in the Art_Tree");
+            }
+
+            size_t same = 0;
+            while(depth + same < bytes.size() && depth + same < other->bytes.size() && bytes[depth + same] == other->bytes[depth + same])
+                same ++;
+
+            Art_Node4<K> *inner = new Art_Node4<K>();
+            inner->prefix = bytes.substr(depth, same);
+            depth += same;
+            *slot = inner;
+
+            for(Leaf *each : {other, leaf}) {
+                if(each->bytes.size() == depth) inner->terminal = each;
+                else                            add_child(slot, static_cast<uint8_t>(each->bytes[depth]), each);
+            }
+            break;
+        }
+
+        Inner *inner = static_cast<Inner*>(node);
+        size_t same = 0, limit = std::min(inner->prefix.size(), bytes.size() - depth);
+        while(same < limit && inner->prefix[same] == bytes[depth + same])
+            same ++;
+
+        if(same < inner->prefix.size()) {
+            // the key leaves the compressed path: split it at the first different byte
+            Art_Node4<K> *parent = new Art_Node4<K>();
+            parent->prefix = inner->prefix.substr(0, same);
+            uint8_t branch = static_cast<uint8_t>(inner->prefix[same]);
+            inner->prefix.erase(0, same + 1);
+            *slot = parent;
+            add_child(slot, branch, inner);
+
+            if(depth + same == bytes.size()) parent->terminal = leaf;
+            else                             add_child(slot, static_cast<uint8_t>(bytes[depth + same]), leaf);
+            break;
+        }
+
+        depth += inner->prefix.size();
+        if(depth == bytes.size()) {
+            if(inner->terminal != nullptr) {
+                delete leaf;
+                throw std::runtime_error("The element has been in the Art_Tree");
+            }
+            inner->terminal = leaf;
+            break;
+        }
+
+        Node **child = find_child(inner, static_cast<uint8_t>(bytes[depth]));
+        if(child == nullptr) {
+            add_child(slot, static_cast<uint8_t>(bytes[depth]), leaf);
+            break;
+        }
+
+        slot = child;
+        depth ++;
+    }
+    num_nodes ++;
+}
+
+template <typename K>
+void Art_Tree<K>::delete_node(const K key) {
+
+    std::string bytes = art_key(key);
+    Node **slot = &root, **parent_slot = nullptr;
+    size_t depth = 0;
+    uint8_t branch = 0;
+
+    while(*slot != nullptr) {
+        Node *node = *slot;
+        if(node->type == Art_Type::LEAF) {
+            if(static_cast<Leaf*>(node)->bytes != bytes)
+                return; // Not found
+
+            delete static_cast<Leaf*>(node);
+            num_nodes --;
+            if(parent_slot == nullptr) {
+                root = nullptr;
+                return;
+            }
+            remove_child(parent_slot, branch);
+            shrink(parent_slot);
+            return;
+        }
+
+        Inner *inner = static_cast<Inner*>(node);
+        if(bytes.compare(depth, inner->prefix.size(), inner->prefix) != 0)
+            return; // Not found
+        depth += inner->prefix.size();
+
+        if(depth == bytes.size()) {
+            if(inner->terminal == nullptr)
+                return; // Not found
+
+            delete inner->terminal;
+            inner->terminal = nullptr;
+            num_nodes --;
+            shrink(slot);
+            return;
+        }
+
+        branch = static_cast<uint8_t>(bytes[depth]);
+        Node **child = find_child(inner, branch);
+        if(child == nullptr)
+            return; // Not found
+
+        parent_slot = slot;
+        slot = child;
+        depth ++;
+    }
+}
+
+template <typename K>
+void Art_Tree<K>::modify_node(const K &key, const K &new_key) {
+
+    // both checks come first, so a failed call leaves the tree unchanged
+    if(std::holds_alternative<std::nullptr_t>(search_node(key))) {
+        throw std::runtime_error("The element is not in the Art_Tree");
+    }
+    if(art_key(key) == art_key(new_key))
+        return;
+    if(!std::holds_alternative<std::nullptr_t>(search_node(new_key))) {
+        throw std::runtime_error("The element has been in the Art_Tree");
+    }
+
+    delete_node(key);
+    insert_node(new_key);
+}
+
+template <typename K>
+template <typename Func>
+void Art_Tree<K>::for_each_with_prefix(const std::string &prefix, Func fn) const {
+
+    // the keys whose bytes start with prefix, in order
+    std::string path;
+    auto visit = [&](const K &key) { fn(key); return true; };
+    if(root != nullptr)
+        walk(root, path, &prefix, &prefix, true, visit);
+}
+
+template <typename K>
+template <typename Func>
+void Art_Tree<K>::for_each_in_range(const K &lo, const K &hi, Func fn) const {
+
+    std::string low = art_key(lo), high = art_key(hi), path;
+    auto visit = [&](const K &key) { fn(key); return true; };
+    if(root != nullptr && low <= high)
+        walk(root, path, &low, &high, false, visit);
+}
+
+template <typename K>
+void Art_Tree<K>::inorder(std::ostream &os) const {
+
+    std::string path;
+    auto visit = [&](const K &key) { os << key << ", "; return true; };
+    if(root != nullptr)
+        walk(root, path, nullptr, nullptr, false, visit);
+    os << std::endl;
+}
+
+template <typename K>
+void Art_Tree<K>::show(std::ostream &os) const {
+
+    os << "Size: " << std::setw(4) << size() << std::endl;
+
+    std::stack<std::pair<const Node*, size_t>> nodes;
+    if(root != nullptr) nodes.push({root, 0});
+
+    while(!nodes.empty()) {
+        auto [node, level] = nodes.top();
+        nodes.pop();
+        os << std::string(2 * level, ' ');
+
+        if(node->type == Art_Type::LEAF) {
+            os << "Leaf: " << static_cast<const Leaf*>(node)->key << std::endl;
+            continue;
+        }
+
+        const Inner *inner = static_cast<const Inner*>(node);
+        static const char *names[] = {"Leaf", "Node4", "Node16", "Node48", "Node256"};
+        os << names[static_cast<size_t>(node->type)] << "(" << inner->num_children << "), "
+           << "Prefix: " << inner->prefix.size() << " bytes";
+        if(inner->terminal != nullptr) os << ", Terminal: " << inner->terminal->key;
+        os << std::endl;
+
+        std::vector<const Node*> children;
+        uint8_t byte = 0;
+        for(size_t pos = 0; const Node *child = next_child(inner, pos, byte); )
+            children.push_back(child);
+        for(auto it = children.rbegin(); it != children.rend(); ++it)
+            nodes.push({*it, level + 1});
+    }
+}
+
+template <typename K>
+inline bool Art_Tree<K>::empty() const {
+    return (size() == 0);
+}
+
+template <typename K>
+inline size_t Art_Tree<K>::size() const {
+    return num_nodes;
+}
+
+template <typename K>
+Art_Tree<K>::Node** Art_Tree<K>::find_child(Inner* node, uint8_t byte) {
+
+    switch(node->type) {
+        case Art_Type::NODE4: {
+            Art_Node4<K> *n = static_cast<Art_Node4<K>*>(node);
+            for(size_t i = 0; i < n->num_children; ++i)
+                if(n->keys[i] == byte) return &(n->children[i]);
+            return nullptr;
+        }
+        case Art_Type::NODE16: {
+            Art_Node16<K> *n = static_cast<Art_Node16<K>*>(node);
+#if defined(__SSE2__)
+            // compare all 16 key bytes at once, masking off the unused tail
+            __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(cmp)) & ((1u << n->num_children) - 1);
+            if(mask != 0) return &(n->children[std::countr_zero(mask)]);
+#else
+            for(size_t i = 0; i < n->num_children; ++i)
+                if(n->keys[i] == byte) return &(n->children[i]);
+#endif
+            return nullptr;
+        }
+        case Art_Type::NODE48: {
+            Art_Node48<K> *n = static_cast<Art_Node48<K>*>(node);
+            if(n->index[byte] != 0) return &(n->children[n->index[byte] - 1]);
+            return nullptr;
+        }
+        case Art_Type::NODE256: {
+            Art_Node256<K> *n = static_cast<Art_Node256<K>*>(node);
+            if(n->children[byte] != nullptr) return &(n->children[byte]);
+            return nullptr;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+template <typename K>
+void Art_Tree<K>::add_child(Node** slot, uint8_t byte, Node* child) {
+
+    // a full node is replaced in its slot by the next larger kind
+    Inner *node = static_cast<Inner*>(*slot);
+
+    switch(node->type) {
+        case Art_Type::NODE4:
+        case Art_Type::NODE16: {
+            bool small = (node->type == Art_Type::NODE4);
+            size_t capacity = (small) ? (4) : (16);
+            uint8_t *keys = (small) ? (static_cast<Art_Node4<K>*>(node)->keys) : (static_cast<Art_Node16<K>*>(node)->keys);
+            Node **children = (small) ? (static_cast<Art_Node4<K>*>(node)->children) : (static_cast<Art_Node16<K>*>(node)->children);
+
+            if(node->num_children < capacity) {
+                size_t pos = 0;
+                while(pos < node->num_children && keys[pos] < byte) pos ++;
+                std::memmove(keys + pos + 1, keys + pos, node->num_children - pos);
+                std::memmove(children + pos + 1, children + pos, (node->num_children - pos) * sizeof(Node*));
+                keys[pos] = byte;
+                children[pos] = child;
+                node->num_children ++;
+                return;
+            }
+
+            Inner *grown = nullptr;
+            if(small) {
+                Art_Node16<K> *n = new Art_Node16<K>();
+                std::memcpy(n->keys, keys, 4);
+                std::memcpy(n->children, children, 4 * sizeof(Node*));
+                grown = n;
+            }
+            else {
+                Art_Node48<K> *n = new Art_Node48<K>();
+                for(size_t i = 0; i < 16; ++i) {
+                    n->index[keys[i]] = static_cast<uint8_t>(i + 1);
+                    n->children[i] = children[i];
+                }
+                grown = n;
+            }
+
+            grown->num_children = node->num_children;
+            grown->prefix = std::move(node->prefix);
+            grown->terminal = node->terminal;
+            *slot = grown;
+            free_node(node);
+            add_child(slot, byte, child);
+            return;
+        }
+        case Art_Type::NODE48: {
+            Art_Node48<K> *n = static_cast<Art_Node48<K>*>(node);
+            if(n->num_children < 48) {
+                // removals keep the slots packed, so the next free slot is num_children
+                n->children[n->num_children] = child;
+                n->index[byte] = static_cast<uint8_t>(++ n->num_children);
+                return;
+            }
+
+            Art_Node256<K> *grown = new Art_Node256<K>();
+            for(size_t b = 0; b < 256; ++b)
+                if(n->index[b] != 0) grown->children[b] = n->children[n->index[b] - 1];
+            grown->num_children = n->num_children;
+            grown->prefix = std::move(n->prefix);
+            grown->terminal = n->terminal;
+            *slot = grown;
+            free_node(n);
+            add_child(slot, byte, child);
+            return;
+        }
+        case Art_Type::NODE256: {
+            Art_Node256<K> *n = static_cast<Art_Node256<K>*>(node);
+            n->children[byte] = child;
+            n->num_children ++;
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+template <typename K>
+void Art_Tree<K>::remove_child(Node** slot, uint8_t byte) {
+
+    Inner *node = static_cast<Inner*>(*slot);
+
+    switch(node->type) {
+        case Art_Type::NODE4:
+        case Art_Type::NODE16: {
+            bool small = (node->type == Art_Type::NODE4);
+            uint8_t *keys = (small) ? (static_cast<Art_Node4<K>*>(node)->keys) : (static_cast<Art_Node16<K>*>(node)->keys);
+            Node **children = (small) ? (static_cast<Art_Node4<K>*>(node)->children) : (static_cast<Art_Node16<K>*>(node)->children);
+
+            size_t pos = 0;
+            while(keys[pos] != byte) pos ++;
+            std::memmove(keys + pos, keys + pos + 1, node->num_children - pos - 1);
+            std::memmove(children + pos, children + pos + 1, (node->num_children - pos - 1) * sizeof(Node*));
+            node->num_children --;
+            return;
+        }
+        case Art_Type::NODE48: {
+            // move the last slot into the hole to keep the slots packed
+            Art_Node48<K> *n = static_cast<Art_Node48<K>*>(node);
+            size_t hole = n->index[byte] - 1, last = n->num_children - 1;
+            n->index[byte] = 0;
+            if(hole != last) {
+                n->children[hole] = n->children[last];
+                for(size_t b = 0; b < 256; ++b) {
+                    if(n->index[b] == last + 1) {
+                        n->index[b] = static_cast<uint8_t>(hole + 1);
+                        break;
+                    }
+                }
+            }
+            n->num_children --;
+            return;
+        }
+        case Art_Type::NODE256: {
+            Art_Node256<K> *n = static_cast<Art_Node256<K>*>(node);
+            n->children[byte] = nullptr;
+            n->num_children --;
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+template <typename K>
+void Art_Tree<K>::shrink(Node** slot) {
+
+    // an inner node always holds at least two keys below it, and moves to a smaller kind well
+    // below the size that made it grow, so a key bouncing at the border does not resize it each time
+    Inner *node = static_cast<Inner*>(*slot);
+    size_t entries = node->num_children + ((node->terminal != nullptr) ? (1) : (0));
+
+    if(entries == 1) {
+        if(node->terminal != nullptr) {
+            *slot = node->terminal;
+        }
+        else {
+            uint8_t byte = 0;
+            size_t pos = 0;
+            Node *child = next_child(node, pos, byte);
+            if(child->type != Art_Type::LEAF) {
+                Inner *inner = static_cast<Inner*>(child);
+                inner->prefix = node->prefix + static_cast<char>(byte) + inner->prefix;
+            }
+            *slot = child;
+        }
+        free_node(node);
+        return;
+    }
+
+    Inner *shrunk = nullptr;
+    if(node->type == Art_Type::NODE256 && node->num_children <= 37) {
+        Art_Node256<K> *n = static_cast<Art_Node256<K>*>(node);
+        Art_Node48<K> *s = new Art_Node48<K>();
+        size_t count = 0;
+        for(size_t b = 0; b < 256; ++b) {
+            if(n->children[b] == nullptr) continue;
+            s->children[count] = n->children[b];
+            s->index[b] = static_cast<uint8_t>(++ count);
+        }
+        shrunk = s;
+    }
+    else if(node->type == Art_Type::NODE48 && node->num_children <= 12) {
+        Art_Node48<K> *n = static_cast<Art_Node48<K>*>(node);
+        Art_Node16<K> *s = new Art_Node16<K>();
+        size_t count = 0;
+        for(size_t b = 0; b < 256; ++b) {
+            if(n->index[b] == 0) continue;
+            s->keys[count] = static_cast<uint8_t>(b);
+            s->children[count ++] = n->children[n->index[b] - 1];
+        }
+        shrunk = s;
+    }
+    else if(node->type == Art_Type::NODE16 && node->num_children <= 3) {
+        Art_Node16<K> *n = static_cast<Art_Node16<K>*>(node);
+        Art_Node4<K> *s = new Art_Node4<K>();
+        std::memcpy(s->keys, n->keys, n->num_children);
+        std::memcpy(s->children, n->children, n->num_children * sizeof(Node*));
+        shrunk = s;
+    }
+
+    if(shrunk == nullptr)
+        return;
+
+    shrunk->num_children = node->num_children;
+    shrunk->prefix = std::move(node->prefix);
+    shrunk->terminal = node->terminal;
+    *slot = shrunk;
+    free_node(node);
+}
+
+template <typename K>
+Art_Tree<K>::Node* Art_Tree<K>::next_child(const Inner* node, size_t &pos, uint8_t &byte) {
+
+    // the child at position >= pos in key order; pos moves past it
+    switch(node->type) {
+        case Art_Type::NODE4:
+        case Art_Type::NODE16: {
+            bool small = (node->type == Art_Type::NODE4);
+            const uint8_t *keys = (small) ? (static_cast<const Art_Node4<K>*>(node)->keys) : (static_cast<const Art_Node16<K>*>(node)->keys);
+            Node *const *children = (small) ? (static_cast<const Art_Node4<K>*>(node)->children) : (static_cast<const Art_Node16<K>*>(node)->children);
+            if(pos >= node->num_children) return nullptr;
+            byte = keys[pos];
+            return children[pos ++];
+        }
+        case Art_Type::NODE48: {
+            const Art_Node48<K> *n = static_cast<const Art_Node48<K>*>(node);
+            for(; pos < 256; ++pos) {
+                if(n->index[pos] == 0) continue;
+                byte = static_cast<uint8_t>(pos);
+                return n->children[n->index[pos ++] - 1];
+            }
+            return nullptr;
+        }
+        case Art_Type::NODE256: {
+            const Art_Node256<K> *n = static_cast<const Art_Node256<K>*>(node);
+            for(; pos < 256; ++pos) {
+                if(n->children[pos] == nullptr) continue;
+                byte = static_cast<uint8_t>(pos);
+                return n->children[pos ++];
+            }
+            return nullptr;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+template <typename K>
+void Art_Tree<K>::free_node(Node* node) {
+
+    // frees the node itself, not what it points to
+    switch(node->type) {
+        case Art_Type::LEAF:    delete static_cast<Leaf*>(node); break;
+        case Art_Type::NODE4:   delete static_cast<Art_Node4<K>*>(node); break;
+        case Art_Type::NODE16:  delete static_cast<Art_Node16<K>*>(node); break;
+        case Art_Type::NODE48:  delete static_cast<Art_Node48<K>*>(node); break;
+        case Art_Type::NODE256: delete static_cast<Art_Node256<K>*>(node); break;
+    }
+}
+
+template <typename K>
+void Art_Tree<K>::release(Node* node) {
+
+    std::vector<Node*> nodes;
+    if(node != nullptr) nodes.push_back(node);
+
+    while(!nodes.empty()) {
+        Node *curr = nodes.back();
+        nodes.pop_back();
+
+        if(curr->type != Art_Type::LEAF) {
+            Inner *inner = static_cast<Inner*>(curr);
+            if(inner->terminal != nullptr) nodes.push_back(inner->terminal);
+
+            uint8_t byte = 0;
+            for(size_t pos = 0; Node *child = next_child(inner, pos, byte); )
+                nodes.push_back(child);
+        }
+        free_node(curr);
+    }
+}
+
+template <typename K>
+template <typename Func>
+bool Art_Tree<K>::walk(const Node* node, std::string &path, const std::string* lo, const std::string* hi, bool hi_is_prefix, Func &fn) {
+
+    // in-order walk with an explicit stack; path holds the bytes above the node on top.
+    // A subtree is skipped when its path already sorts below lo, and the walk stops once it sorts above hi.
+    // fn returns false to stop. Returns false when stopped.
+    struct Frame {
+        const Inner *node;
+        size_t pos;
+        size_t base;  // path length when the node was entered, before its prefix
+    };
+
+    auto below = [&](const std::string &bytes) {
+        size_t n = std::min(bytes.size(), lo->size());
+        return bytes.compare(0, n, *lo, 0, n) < 0;
+    };
+    auto above = [&](const std::string &bytes) {
+        size_t n = std::min(bytes.size(), hi->size());
+        return bytes.compare(0, n, *hi, 0, n) > 0;
+    };
+
+    std::vector<Frame> frames;
+    size_t base = path.size();
+
+    while(true) {
+        if(node != nullptr) {
+            if(node->type == Art_Type::LEAF) {
+                const Leaf *leaf = static_cast<const Leaf*>(node);
+                bool too_high = (hi != nullptr) && ((hi_is_prefix) ? (above(leaf->bytes)) : (leaf->bytes > *hi));
+                if(too_high)
+                    return false;
+                if((lo == nullptr || !(leaf->bytes < *lo)) && !fn(leaf->key))
+                    return false;
+            }
+            else {
+                const Inner *inner = static_cast<const Inner*>(node);
+                path.append(inner->prefix);
+
+                if(hi != nullptr && above(path))
+                    return false;
+
+                if(lo == nullptr || !below(path)) {
+                    // the terminal key is the path itself and sorts before every child
+                    const Leaf *leaf = inner->terminal;
+                    if(leaf != nullptr) {
+                        bool too_high = (hi != nullptr) && ((hi_is_prefix) ? (above(leaf->bytes)) : (leaf->bytes > *hi));
+                        if(too_high)
+                            return false;
+                        if((lo == nullptr || !(leaf->bytes < *lo)) && !fn(leaf->key))
+                            return false;
+                    }
+                    frames.push_back({inner, 0, base});
+                }
+                else {
+                    path.resize(base);
+                }
+            }
+        }
+
+        // move to the next child of the deepest unfinished node
+        node = nullptr;
+        while(!frames.empty()) {
+            Frame &top = frames.back();
+            path.resize(top.base + top.node->prefix.size());
+
+            uint8_t byte = 0;
+            const Node *child = next_child(top.node, top.pos, byte);
+            if(child != nullptr) {
+                path.push_back(static_cast<char>(byte));
+                base = path.size();
+                node = child;
+                break;
+            }
+
+            path.resize(top.base);
+            frames.pop_back();
+        }
+
+        if(node == nullptr)
+            return true;
+    }
+}
+
+}
@@ -7,18 +7,50 @@
 #include <iomanip>
 #include <utility>
 #include <variant>
+#include <iterator>
+#include <vector>
 #include <stack>
+#include <tuple>
 #include <algorithm>
+#include <memory>
+#include "../utils.hpp"
+#include "eytzinger_tree.hpp"
 
 /* Declaration */
 namespace ds_imp {
 
+template <typename T>
+struct AVL_Node;
+
+template <typename T>
+using AVL_Split_Result = std::tuple<AVL_Node<T>*, AVL_Node<T>*, AVL_Node<T>*>;
+
+template <typename T>
+AVL_Node<T>* join(AVL_Node<T>* node_left, AVL_Node<T>* mid, AVL_Node<T>* node_right);
+
+template <typename T>
+AVL_Node<T>* join2(AVL_Node<T>* node_left, AVL_Node<T>* node_right);
+
+template <typename T>
+AVL_Split_Result<T> split(AVL_Node<T>* node_x, const T &ele);
+
+template <typename T>
+AVL_Node<T>* union_nodes(AVL_Node<T>* node_x, AVL_Node<T>* node_y, size_t depth);
+
+template <typename T>
+AVL_Node<T>* intersect_nodes(AVL_Node<T>* node_x, AVL_Node<T>* node_y, size_t depth);
+
+template <typename T>
+AVL_Node<T>* difference_nodes(AVL_Node<T>* node_x, AVL_Node<T>* node_y, size_t depth);
+
 template <typename T>
 struct AVL_Node {
     T element;
     AVL_Node<T> *left;
     AVL_Node<T> *right;
+    AVL_Node<T> *parent;    // set by the parent's update(), stale on the root
     size_t height;
+    size_t num_nodes;
     int32_t bf;
 
     /* Constructor */
@@ -28,8 +60,8 @@ struct AVL_Node {
     /* Destructor */
     ~AVL_Node();
 
-    AVL_Node<T>* insert(const T &ele);
-    AVL_Node<T>* insert(T &&ele);
+    static void release(AVL_Node<T>* node);
+
     void preorder(std::ostream &os);
     void inorder(std::ostream &os);
     void postorder(std::ostream &os);
@@ -41,6 +73,32 @@ struct AVL_Node {
     AVL_Node<T>* right_rotate();
 };
 
+template <typename T>
+class AVL_Iterator {
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const T*;
+        using reference         = const T&;
+
+        AVL_Iterator(AVL_Node<T>* root = nullptr, AVL_Node<T>* curr = nullptr);
+
+        reference operator*()  const;
+        pointer   operator->() const;
+        AVL_Iterator<T>& operator++();
+        AVL_Iterator<T>  operator++(int);
+        AVL_Iterator<T>& operator--();
+        AVL_Iterator<T>  operator--(int);
+        bool operator==(const AVL_Iterator<T> &other) const;
+        bool operator!=(const AVL_Iterator<T> &other) const;
+
+    private:
+        AVL_Node<T> *root;
+        AVL_Node<T> *curr;  // nullptr is end()
+};
+
 template <typename T> 
 class AVL_Tree {
 
@@ -48,12 +106,22 @@ class AVL_Tree {
     using Result = std::variant<std::nullptr_t, T>;
 
     public:
+        using iterator = AVL_Iterator<T>;
+
         AVL_Tree();
+        template <typename Iter>
+        AVL_Tree(Iter first, Iter last);
         ~AVL_Tree();
 
         Result get_min() const;
         Result get_max() const;
         Pair_Result search_node(const T &ele);
+        Result select(size_t k) const;
+        size_t rank(const T &ele) const;
+        size_t count_range(const T &lo, const T &hi) const;
+        void set_union(AVL_Tree<T> &&other);
+        void set_intersection(AVL_Tree<T> &&other);
+        void set_difference(AVL_Tree<T> &&other);
         void insert_node(const T  &ele);
         void insert_node(T &&ele);
         void delete_node(const T ele);
@@ -66,6 +134,17 @@ class AVL_Tree {
         inline bool empty() const;
         inline size_t size() const;
         inline size_t height() const;
+        iterator begin() const;
+        iterator end() const;
+        iterator lower_bound(const T &ele) const;
+        iterator upper_bound(const T &ele) const;
+        std::pair<iterator, iterator> equal_range(const T &ele) const;
+        template <typename Func>
+        void for_each_in_range(const T &lo, const T &hi, Func fn) const;
+        Eytzinger_Tree<T> freeze() const;
+
+        static const size_t PARALLEL_GRAIN = 4096;
+        static const size_t MAX_HEIGHT = 96;  // 1.44 * log2(2^64) < 96
     
     private:
         AVL_Node<T> *root;
@@ -75,6 +154,12 @@ class AVL_Tree {
 
         void update_min_ptr();
         void update_max_ptr();
+        size_t count_less(const T &ele, bool inclusive) const;
+        void refresh();
+        AVL_Node<T>* build(std::vector<T> &elements, size_t lo, size_t hi);
+        AVL_Node<T>* trace_path(const T &ele, AVL_Node<T>** path, size_t &depth) const;
+        void attach(AVL_Node<T>* node, AVL_Node<T>** path, size_t depth);
+        void retrace(AVL_Node<T>** path, size_t depth);
 };
 
 }
@@ -85,97 +170,131 @@ namespace ds_imp {
 /* AVL_Node */
 template <typename T>
 AVL_Node<T>::AVL_Node(const T &ele, AVL_Node<T>* left, AVL_Node<T>* right) 
-    : element(ele), left(left), right(right) {
+    : element(ele), left(left), right(right), parent(nullptr) {
     update();
 }
 
 template <typename T>
 AVL_Node<T>::AVL_Node(T &&ele, AVL_Node<T>* left, AVL_Node<T>* right) 
-    : element(std::move(ele)), left(left), right(right) {
+    : element(std::move(ele)), left(left), right(right), parent(nullptr) {
     update();
 }
 
 template <typename T>
 AVL_Node<T>::~AVL_Node() {
 
-    if( left != nullptr)  delete left;
-    if(right != nullptr)  delete right;
+    // iterative destruction
+    release(left);
+    release(right);
 }
 
 template <typename T>
-AVL_Node<T>* AVL_Node<T>::insert(const T &ele) {
-
-    if     (ele > element && right == nullptr) right = new AVL_Node<T>(ele);
-    else if(ele < element &&  left == nullptr)  left = new AVL_Node<T>(ele);
-    else if(ele > element) /* (right != nullptr) */ right = right->insert(ele);
-    else /* (ele < element) && (left != nullptr) */  left =  left->insert(ele);
-
-    update();
-    
-    if(-1 <= bf && bf <= 1) 
-        return this;
-
-    return this->rotate();
+void AVL_Node<T>::release(AVL_Node<T>* node) {
+
+    // rotate left children up until the subtree becomes a right chain, then free the chain
+    AVL_Node<T> *temp = nullptr;
+    while(node != nullptr) {
+        if(node->left != nullptr) {
+            temp = node->left;
+            node->left = temp->right;
+            temp->right = node;
+            node = temp;
+        }
+        else {
+            temp = node->right;
+            node->right = nullptr;
+            delete node;
+            node = temp;
+        }
+    }
 }
 
 template <typename T>
-AVL_Node<T>* AVL_Node<T>::insert(T &&ele) {
-
-    if     (ele > element && right == nullptr) right = new AVL_Node<T>(std::move(ele));
-    else if(ele < element &&  left == nullptr)  left = new AVL_Node<T>(std::move(ele));
-    else if(ele > element) /* (right != nullptr) */ right = right->insert(std::move(ele));
-    else /* (ele < element) && (left != nullptr) */  left =  left->insert(std::move(ele));
-
-    update();
+void AVL_Node<T>::preorder(std::ostream &os) {
     
-    if(-1 <= bf && bf <= 1) 
-        return this;
+    std::stack<AVL_Node<T>*> nodes;
+    nodes.push(this);
 
-    return this->rotate();
-}
+    while(!nodes.empty()) {
+        decltype(this) curr = nodes.top();
+        nodes.pop();
 
-template <typename T>
-void AVL_Node<T>::preorder(std::ostream &os) {
-    
-    os << element << ", ";
-    if( left != nullptr) left->preorder(os);
-    if(right != nullptr) right->preorder(os);
+        os << curr->element << ", ";
+        if(curr->right != nullptr) nodes.push(curr->right);
+        if(curr-> left != nullptr) nodes.push(curr->left);
+    }
 }
 
 template <typename T>
 void AVL_Node<T>::inorder(std::ostream &os) {
 
-    if( left != nullptr) left->inorder(os);
-    os << element << ", ";
-    if(right != nullptr) right->inorder(os);
+    std::stack<AVL_Node<T>*> nodes;
+    decltype(this) curr = this;
+
+    while(curr != nullptr || !nodes.empty()) {
+        while(curr != nullptr) {
+            nodes.push(curr);
+            curr = curr->left;
+        }
+
+        curr = nodes.top();
+        nodes.pop();
+        os << curr->element << ", ";
+        curr = curr->right;
+    }
 }
 
 template <typename T>
 void AVL_Node<T>::postorder(std::ostream &os) {
 
-    if( left != nullptr) left->postorder(os);
-    if(right != nullptr) right->postorder(os);
-    os << element << ", ";
+    std::stack<AVL_Node<T>*> nodes;
+    decltype(this) curr = this, last = nullptr;
+
+    while(curr != nullptr || !nodes.empty()) {
+        if(curr != nullptr) {
+            nodes.push(curr);
+            curr = curr->left;
+            continue;
+        }
+
+        decltype(this) top = nodes.top();
+        if(top->right != nullptr && top->right != last) {
+            curr = top->right;
+        }
+        else {
+            os << top->element << ", ";
+            last = top;
+            nodes.pop();
+        }
+    }
 }
 
 template <typename T>
 void AVL_Node<T>::show(std::ostream &os) {
 
-    os << "Node(" << height << "): "
-       << std::setw(4) << element << ", ";
+    std::stack<AVL_Node<T>*> nodes;
+    nodes.push(this);
 
-    os << "Left: ";
-    if (!left) os << "null";
-    else       os << std::setw(4) << left->element;
-    os << ", ";
+    while(!nodes.empty()) {
+        decltype(this) curr = nodes.top();
+        nodes.pop();
 
-    os << "Right: ";
-    if (!right) os << "null";
-    else        os << std::setw(4) << right->element;
-    os << std::endl;
+        os << "Node(" << curr->height << "): "
+           << std::setw(4) << curr->element << ", ";
+
+        os << "Left: ";
+        if (!curr->left) os << "null";
+        else             os << std::setw(4) << curr->left->element;
+        os << ", ";
 
-    if(left)  left->show(os);
-    if(right) right->show(os);
+        os << "Right: ";
+        if (!curr->right) os << "null";
+        else              os << std::setw(4) << curr->right->element;
+        os << std::endl;
+
+        if(curr->right) nodes.push(curr->right);
+        if(curr->left)  nodes.push(curr->left);
+    }
 }
 
 template <typename T>
@@ -183,7 +302,13 @@ void AVL_Node<T>::update() {
     size_t left_h  = ( left == nullptr) ? (0llu) : ( left->height),
            right_h = (right == nullptr) ? (0llu) : (right->height);
     this->height = std::max(left_h, right_h) + 1;
+    this->num_nodes = (( left == nullptr) ? (0) : ( left->num_nodes)) + 
+                      ((right == nullptr) ? (0) : (right->num_nodes)) + 1;
     this->bf = (static_cast<int32_t>(left_h)) - right_h;
+
+    // every change to a child pointer is followed by update(), which keeps the parent pointers right
+    if( left != nullptr)  left->parent = this;
+    if(right != nullptr) right->parent = this;
 }
 
 template <typename T>
@@ -192,17 +317,17 @@ AVL_Node<T>* AVL_Node<T>::rotate() {
     if(-1 <= bf && bf <= 1)
         return this;
 
-    if     (bf >= 2 && left->bf >= 1)      { // LL
+    if     (bf >= 2 && left->bf >= 0)      { // LL
         return this->right_rotate();
     }
-    else if(bf >= 2) /* left->bf < 1 */    { // LR
+    else if(bf >= 2) /* left->bf < 0 */    { // LR
         left = left->left_rotate();
         return this->right_rotate();
     }
-    else if(bf <= -2 && right->bf <= -1)   { // RR
+    else if(bf <= -2 && right->bf <= 0)    { // RR
         return this->left_rotate();
     }
-    else/* (bf <= -2 && right->bf > -1) */ { // RL
+    else/* (bf <= -2 && right->bf > 0) */  { // RL
         right = right->right_rotate();
         return this->left_rotate();
     }
@@ -234,6 +359,236 @@ AVL_Node<T>* AVL_Node<T>::right_rotate() {
     return ret_root;
 }
 
+template <typename T>
+AVL_Node<T>* join(AVL_Node<T>* node_left, AVL_Node<T>* mid, AVL_Node<T>* node_right) {
+
+    // every key in node_left < mid->element < every key in node_right
+    size_t left_h  = ( node_left == nullptr) ? (0) : ( node_left->height),
+           right_h = (node_right == nullptr) ? (0) : (node_right->height);
+
+    if(left_h > right_h + 1) {
+        node_left->right = join<T>(node_left->right, mid, node_right);
+        node_left->update();
+        return node_left->rotate();
+    }
+    else if(right_h > left_h + 1) {
+        node_right->left = join<T>(node_left, mid, node_right->left);
+        node_right->update();
+        return node_right->rotate();
+    }
+
+    mid->left  = node_left;
+    mid->right = node_right;
+    mid->update();
+    return mid;
+}
+
+template <typename T>
+AVL_Node<T>* join2(AVL_Node<T>* node_left, AVL_Node<T>* node_right) {
+
+    if(node_left == nullptr) return node_right;
+
+    // detach the maximum of node_left and use it as the middle node
+    std::stack<AVL_Node<T>*> spine;
+    AVL_Node<T> *last = node_left;
+    while(last->right != nullptr) {
+        spine.push(last);
+        last = last->right;
+    }
+
+    AVL_Node<T> *rest = last->left;
+    while(!spine.empty()) {
+        AVL_Node<T> *node = spine.top();
+        spine.pop();
+        rest = join<T>(node->left, node, rest);
+    }
+
+    return join<T>(rest, last, node_right);
+}
+
+template <typename T>
+AVL_Split_Result<T> split(AVL_Node<T>* node_x, const T &ele) {
+
+    // {elements < ele, the node equal to ele, elements > ele}
+    if(node_x == nullptr) return {nullptr, nullptr, nullptr};
+
+    AVL_Node<T> *left = node_x->left, *right = node_x->right, *mid = nullptr;
+    node_x->left = node_x->right = nullptr;
+
+    if(ele == node_x->element) {
+        node_x->update();
+        return {left, node_x, right};
+    }
+    else if(ele < node_x->element) {
+        AVL_Node<T> *less = nullptr, *greater = nullptr;
+        std::tie(less, mid, greater) = split<T>(left, ele);
+        return {less, mid, join<T>(greater, node_x, right)};
+    }
+    else /* ele > node_x->element */ {
+        AVL_Node<T> *less = nullptr, *greater = nullptr;
+        std::tie(less, mid, greater) = split<T>(right, ele);
+        return {join<T>(left, node_x, less), mid, greater};
+    }
+}
+
+template <typename T>
+AVL_Node<T>* union_nodes(AVL_Node<T>* node_x, AVL_Node<T>* node_y, size_t depth) {
+
+    if(node_x == nullptr) return node_y;
+    if(node_y == nullptr) return node_x;
+
+    AVL_Node<T> *less = nullptr, *equal = nullptr, *greater = nullptr;
+    std::tie(less, equal, greater) = split<T>(node_y, node_x->element);
+    if(equal != nullptr) delete equal;
+
+    size_t fork = (node_x->num_nodes >= AVL_Tree<T>::PARALLEL_GRAIN) ? (depth) : (0);
+    size_t next = (depth > 0) ? (depth - 1) : (0);
+    AVL_Node<T> *left = node_x->left, *right = node_x->right;
+
+    fork_join(fork,
+        [&] { left  = union_nodes<T>(left , less   , next); },
+        [&] { right = union_nodes<T>(right, greater, next); }
+    );
+    return join<T>(left, node_x, right);
+}
+
+template <typename T>
+AVL_Node<T>* intersect_nodes(AVL_Node<T>* node_x, AVL_Node<T>* node_y, size_t depth) {
+
+    if(node_x == nullptr || node_y == nullptr) {
+        AVL_Node<T>::release(node_x);
+        AVL_Node<T>::release(node_y);
+        return nullptr;
+    }
+
+    AVL_Node<T> *less = nullptr, *equal = nullptr, *greater = nullptr;
+    std::tie(less, equal, greater) = split<T>(node_y, node_x->element);
+
+    size_t fork = (node_x->num_nodes >= AVL_Tree<T>::PARALLEL_GRAIN) ? (depth) : (0);
+    size_t next = (depth > 0) ? (depth - 1) : (0);
+    AVL_Node<T> *left = node_x->left, *right = node_x->right;
+    node_x->left = node_x->right = nullptr;
+
+    fork_join(fork,
+        [&] { left  = intersect_nodes<T>(left , less   , next); },
+        [&] { right = intersect_nodes<T>(right, greater, next); }
+    );
+
+    if(equal != nullptr) {
+        delete equal;
+        return join<T>(left, node_x, right);
+    }
+
+    delete node_x;
+    return join2<T>(left, right);
+}
+
+template <typename T>
+AVL_Node<T>* difference_nodes(AVL_Node<T>* node_x, AVL_Node<T>* node_y, size_t depth) {
+
+    // the elements of node_x that are not in node_y
+    if(node_x == nullptr) {
+        AVL_Node<T>::release(node_y);
+        return nullptr;
+    }
+    if(node_y == nullptr) return node_x;
+
+    AVL_Node<T> *less = nullptr, *equal = nullptr, *greater = nullptr;
+    std::tie(less, equal, greater) = split<T>(node_x, node_y->element);
+    if(equal != nullptr) delete equal;
+
+    size_t fork = (node_y->num_nodes >= AVL_Tree<T>::PARALLEL_GRAIN) ? (depth) : (0);
+    size_t next = (depth > 0) ? (depth - 1) : (0);
+    AVL_Node<T> *left = node_y->left, *right = node_y->right;
+    node_y->left = node_y->right = nullptr;
+    delete node_y;
+
+    fork_join(fork,
+        [&] { less    = difference_nodes<T>(less   , left , next); },
+        [&] { greater = difference_nodes<T>(greater, right, next); }
+    );
+    return join2<T>(less, greater);
+}
+
+/* AVL_Iterator */
+template <typename T>
+AVL_Iterator<T>::AVL_Iterator(AVL_Node<T>* root, AVL_Node<T>* curr) 
+    : root(root), curr(curr) {}
+
+template <typename T>
+AVL_Iterator<T>::reference AVL_Iterator<T>::operator*() const {
+    return curr->element;
+}
+
+template <typename T>
+AVL_Iterator<T>::pointer AVL_Iterator<T>::operator->() const {
+    return &(curr->element);
+}
+
+template <typename T>
+AVL_Iterator<T>& AVL_Iterator<T>::operator++() {
+
+    assert(curr != nullptr);
+
+    if(curr->right != nullptr) {
+        curr = curr->right;
+        while(curr->left != nullptr) curr = curr->left;
+        return *this;
+    }
+
+    // the successor is the first ancestor reached from its left subtree, the climb stops at root
+    while(curr != root && curr->parent->right == curr) curr = curr->parent;
+    curr = (curr == root) ? (nullptr) : (curr->parent);
+    return *this;
+}
+
+template <typename T>
+AVL_Iterator<T> AVL_Iterator<T>::operator++(int) {
+
+    AVL_Iterator<T> temp = *this;
+    ++(*this);
+    return temp;
+}
+
+template <typename T>
+AVL_Iterator<T>& AVL_Iterator<T>::operator--() {
+
+    if(curr == nullptr) {
+        curr = root;
+        while(curr != nullptr && curr->right != nullptr) curr = curr->right;
+        return *this;
+    }
+
+    if(curr->left != nullptr) {
+        curr = curr->left;
+        while(curr->right != nullptr) curr = curr->right;
+        return *this;
+    }
+
+    // the predecessor is the first ancestor reached from its right subtree, the climb stops at root
+    while(curr != root && curr->parent->left == curr) curr = curr->parent;
+    curr = (curr == root) ? (nullptr) : (curr->parent);
+    return *this;
+}
+
+template <typename T>
+AVL_Iterator<T> AVL_Iterator<T>::operator--(int) {
+
+    AVL_Iterator<T> temp = *this;
+    --(*this);
+    return temp;
+}
+
+template <typename T>
+bool AVL_Iterator<T>::operator==(const AVL_Iterator<T> &other) const {
+    return curr == other.curr;
+}
+
+template <typename T>
+bool AVL_Iterator<T>::operator!=(const AVL_Iterator<T> &other) const {
+    return curr != other.curr;
+}
+
 /* AVL_Tree */
 template <typename T> 
 AVL_Tree<T>::AVL_Tree() 
@@ -242,6 +597,26 @@ AVL_Tree<T>::AVL_Tree()
       min_ptr(nullptr), 
       num_nodes(0) {}
 
+template <typename T> 
+template <typename Iter>
+AVL_Tree<T>::AVL_Tree(Iter first, Iter last) : AVL_Tree() {
+
+    // bulk loading: sort the input if needed, then build a perfectly balanced tree in O(n)
+    std::vector<T> elements(first, last);
+    if(!std::is_sorted(elements.begin(), elements.end()))
+        std::sort(elements.begin(), elements.end());
+    
+    if(std::adjacent_find(elements.begin(), elements.end()) != elements.end()) {
+        throw std::runtime_error("The element has been in the AVL_Tree");
+    }
+
+    root = build(elements, 0, elements.size());
+    num_nodes = elements.size();
+
+    update_max_ptr();
+    update_min_ptr();
+}
+
 template <typename T> 
 AVL_Tree<T>::~AVL_Tree() {
 
@@ -281,126 +656,136 @@ AVL_Tree<T>::Pair_Result AVL_Tree<T>::search_node(const T &ele) {
     return {parent, curr};
 }
 
+template <typename T> 
+AVL_Tree<T>::Result AVL_Tree<T>::select(size_t k) const {
+
+    // k-th smallest element, 0-indexed
+    if(k >= size())
+        return nullptr;
+
+    decltype(root) curr = root;
+    while(curr != nullptr) {
+        size_t left_n = (curr->left == nullptr) ? (0) : (curr->left->num_nodes);
+        
+        if     (k < left_n)  curr = curr->left;
+        else if(k > left_n)  { k -= left_n + 1; curr = curr->right; }
+        else                 return curr->element;
+    }
+    return nullptr;
+}
+
+template <typename T> 
+size_t AVL_Tree<T>::rank(const T &ele) const {
+    return count_less(ele, false);
+}
+
+template <typename T> 
+size_t AVL_Tree<T>::count_range(const T &lo, const T &hi) const {
+
+    // the number of elements in [lo, hi]
+    if(hi < lo)
+        return 0;
+    return count_less(hi, true) - count_less(lo, false);
+}
+
+template <typename T> 
+void AVL_Tree<T>::set_union(AVL_Tree<T> &&other) {
+
+    if(this == &other)
+        return;
+
+    root = union_nodes<T>(root, other.root, fork_depth());
+    other.root = nullptr;
+    other.refresh();
+    refresh();
+}
+
+template <typename T> 
+void AVL_Tree<T>::set_intersection(AVL_Tree<T> &&other) {
+
+    if(this == &other)
+        return;
+
+    root = intersect_nodes<T>(root, other.root, fork_depth());
+    other.root = nullptr;
+    other.refresh();
+    refresh();
+}
+
+template <typename T> 
+void AVL_Tree<T>::set_difference(AVL_Tree<T> &&other) {
+
+    if(this == &other) {
+        AVL_Node<T>::release(root);
+        root = nullptr;
+        refresh();
+        return;
+    }
+
+    root = difference_nodes<T>(root, other.root, fork_depth());
+    other.root = nullptr;
+    other.refresh();
+    refresh();
+}
+
 template <typename T> 
 void AVL_Tree<T>::insert_node(const T &ele) {
 
-    auto search_result = search_node(ele);
+    AVL_Node<T> *path[MAX_HEIGHT];
+    size_t depth = 0;
     
-    if(search_result.second != nullptr) {
+    if(trace_path(ele, path, depth) != nullptr) {
         throw std::runtime_error("The element has been in the AVL_Tree");
     }
 
-    if(empty()) root = new AVL_Node<T>(ele);
-    else        root = root->insert(ele);
-    num_nodes ++;
-    update_max_ptr();
-    update_min_ptr();
+    attach(new AVL_Node<T>(ele), path, depth);
     return;
 }
 
 template <typename T> 
 void AVL_Tree<T>::insert_node(T &&ele) {
 
-    auto search_result = search_node(ele);
+    AVL_Node<T> *path[MAX_HEIGHT];
+    size_t depth = 0;
     
-    if(search_result.second != nullptr) {
+    if(trace_path(ele, path, depth) != nullptr) {
         throw std::runtime_error("The element has been in the AVL_Tree");
     }
 
-    if(empty()) root = new AVL_Node<T>(std::move(ele));
-    else        root = root->insert(std::move(ele));
-    num_nodes ++;
-    update_max_ptr();
-    update_min_ptr();
+    attach(new AVL_Node<T>(std::move(ele)), path, depth);
     return;
 }
 
 template <typename T> 
 void AVL_Tree<T>::delete_node(const T ele) {
-    using NodePtr = AVL_Node<T>*;
 
-    NodePtr curr = root, target = nullptr, trg_parent = nullptr;
-    std::stack<NodePtr> ancestors;
-
-    while(curr != nullptr) {
-        if(curr->element == ele) {
-            target = curr;
-            break;
-        } 
-        else if(curr->element < ele) {
-            ancestors.push(curr);
-            trg_parent = curr;
-            curr = curr->right; 
-        } 
-        else {
-            ancestors.push(curr);
-            trg_parent = curr;
-            curr = curr->left; 
-        }
-    }
+    AVL_Node<T> *path[MAX_HEIGHT];
+    size_t depth = 0;
 
+    AVL_Node<T> *target = trace_path(ele, path, depth);
     if (target == nullptr) return; // Not found
 
-    NodePtr new_subtree = nullptr;
-
-    if (target->left == nullptr && target->right == nullptr) {
-        // Case 1: Leaf
-        new_subtree = nullptr;
-        delete target;
-    } 
-    else if (target->left == nullptr) {
-        // Case 2: Only right child
-        new_subtree = target->right;
-        target->right = nullptr;
-        delete target;
-    } 
-    else if (target->right == nullptr) {
-        // Case 3: Only left child
-        new_subtree = target->left;
-        target->left = nullptr;
-        delete target;
-    } 
-    else {
-        // Case 4: Two children
-        NodePtr succ = target->right;
-        ancestors.push(target);
-
-        while(succ->left != nullptr) {
-            ancestors.push(succ);
-            succ = succ->left;
+    AVL_Node<T> *removed = target;
+    if(target->left != nullptr && target->right != nullptr) {
+        // Two children: move the successor into the target and remove the successor instead
+        path[depth++] = target;
+        removed = target->right;
+        while(removed->left != nullptr) {
+            path[depth++] = removed;
+            removed = removed->left;
         }
-
-        target->element = std::move(succ->element); 
-
-        NodePtr succ_parent = ancestors.top();
-        if(succ_parent->left == succ)  succ_parent->left = succ->right;
-        else                           succ_parent->right = succ->right;
-
-        succ->right = succ->left = nullptr;
-        delete succ;
-
-        new_subtree = target;
+        target->element = std::move(removed->element);
     }
 
-    if(trg_parent == nullptr)           root = new_subtree;
-    else if(ele < trg_parent->element)  trg_parent->left = new_subtree;
-    else                                trg_parent->right = new_subtree;
-    
-    while(!ancestors.empty()) {
-        NodePtr node = ancestors.top();
-        ancestors.pop();
+    AVL_Node<T> *new_subtree = (removed->left != nullptr) ? (removed->left) : (removed->right);
 
-        node->update();
-        NodePtr rotated = node->rotate();
-
-        if(!ancestors.empty()) {
-            NodePtr parent = ancestors.top();
-            if(parent->left == node)  parent->left = rotated;
-            else                      parent->right = rotated;
-        } else {
-            root = rotated;
-        }
-    }
+    if(depth == 0)                          root = new_subtree;
+    else if(path[depth - 1]->left == removed) path[depth - 1]->left  = new_subtree;
+    else                                    path[depth - 1]->right = new_subtree;
+
+    removed->left = removed->right = nullptr;
+    delete removed;
+    retrace(path, depth);
 
     num_nodes --;
     update_max_ptr();
@@ -463,6 +848,92 @@ void AVL_Tree<T>::show(std::ostream &os) {
     if(root) root->show(os);
 }
 
+template <typename T> 
+AVL_Tree<T>::iterator AVL_Tree<T>::begin() const {
+    return iterator(root, min_ptr);
+}
+
+template <typename T> 
+AVL_Tree<T>::iterator AVL_Tree<T>::end() const {
+    return iterator(root, nullptr);
+}
+
+template <typename T> 
+AVL_Tree<T>::iterator AVL_Tree<T>::lower_bound(const T &ele) const {
+
+    // the first element >= ele
+    AVL_Node<T> *curr = root, *bound = nullptr;
+    while(curr != nullptr) {
+        if(curr->element < ele) curr = curr->right;
+        else                    { bound = curr; curr = curr->left; }
+    }
+    return iterator(root, bound);
+}
+
+template <typename T> 
+AVL_Tree<T>::iterator AVL_Tree<T>::upper_bound(const T &ele) const {
+
+    // the first element > ele
+    AVL_Node<T> *curr = root, *bound = nullptr;
+    while(curr != nullptr) {
+        if(ele < curr->element) { bound = curr; curr = curr->left; }
+        else                    curr = curr->right;
+    }
+    return iterator(root, bound);
+}
+
+template <typename T> 
+std::pair<typename AVL_Tree<T>::iterator, typename AVL_Tree<T>::iterator> AVL_Tree<T>::equal_range(const T &ele) const {
+    return {lower_bound(ele), upper_bound(ele)};
+}
+
+template <typename T> 
+template <typename Func>
+void AVL_Tree<T>::for_each_in_range(const T &lo, const T &hi, Func fn) const {
+
+    // in-order walk over [lo, hi] that never descends into subtrees outside the range
+    std::stack<AVL_Node<T>*> nodes;
+    AVL_Node<T> *curr = root;
+
+    while(curr != nullptr || !nodes.empty()) {
+        while(curr != nullptr) {
+            if(curr->element < lo) {
+                curr = curr->right;
+            }
+            else {
+                nodes.push(curr);
+                curr = curr->left;
+            }
+        }
+
+        if(nodes.empty())
+            break;
+
+        curr = nodes.top();
+        nodes.pop();
+        if(hi < curr->element)
+            break;
+
+        fn(curr->element);
+        curr = curr->right;
+    }
+}
+
+template <typename T> 
+Eytzinger_Tree<T> AVL_Tree<T>::freeze() const {
+
+    // read-only snapshot, later changes of the tree are not reflected
+    if(empty())
+        return Eytzinger_Tree<T>();
+
+    std::vector<T> elements;
+    elements.reserve(size());
+    for_each_in_range(min_ptr->element, max_ptr->element, [&](const T &ele) {
+        elements.push_back(ele);
+    });
+    return Eytzinger_Tree<T>(elements.begin(), elements.end());
+}
+
 template <typename T> 
 inline bool AVL_Tree<T>::empty() const {
     return (size() == 0);
@@ -494,4 +965,89 @@ void AVL_Tree<T>::update_max_ptr() {
     }
 }
     
+template <typename T> 
+size_t AVL_Tree<T>::count_less(const T &ele, bool inclusive) const {
+
+    // the number of elements < ele (or <= ele when inclusive)
+    size_t count = 0;
+    decltype(root) curr = root;
+
+    while(curr != nullptr) {
+        if(curr->element < ele || (inclusive && curr->element == ele)) {
+            count += ((curr->left == nullptr) ? (0) : (curr->left->num_nodes)) + 1;
+            curr = curr->right;
+        }
+        else
+            curr = curr->left;
+    }
+    return count;
+}
+
+template <typename T> 
+void AVL_Tree<T>::refresh() {
+
+    num_nodes = (root == nullptr) ? (0) : (root->num_nodes);
+    update_max_ptr();
+    update_min_ptr();
+}
+
+template <typename T> 
+AVL_Node<T>* AVL_Tree<T>::trace_path(const T &ele, AVL_Node<T>** path, size_t &depth) const {
+
+    // record the ancestors of ele in path[0 .. depth), return the node holding ele
+    AVL_Node<T> *curr = root;
+    while(curr != nullptr && curr->element != ele) {
+        path[depth++] = curr;
+        if(curr->element < ele) curr = curr->right;
+        else                    curr = curr->left;
+    }
+    return curr;
+}
+
+template <typename T> 
+void AVL_Tree<T>::attach(AVL_Node<T>* node, AVL_Node<T>** path, size_t depth) {
+
+    if(depth == 0)                                   root = node;
+    else if(path[depth - 1]->element < node->element) path[depth - 1]->right = node;
+    else                                             path[depth - 1]->left  = node;
+
+    retrace(path, depth);
+
+    num_nodes ++;
+    update_max_ptr();
+    update_min_ptr();
+}
+
+template <typename T> 
+void AVL_Tree<T>::retrace(AVL_Node<T>** path, size_t depth) {
+
+    // rebalance from the deepest ancestor up, every ancestor also refreshes its num_nodes
+    while(depth > 0) {
+        AVL_Node<T> *node = path[--depth];
+
+        node->update();
+        AVL_Node<T> *rotated = node->rotate();
+
+        if(depth == 0)                         root = rotated;
+        else if(path[depth - 1]->left == node) path[depth - 1]->left  = rotated;
+        else                                   path[depth - 1]->right = rotated;
+    }
+}
+
+template <typename T> 
+AVL_Node<T>* AVL_Tree<T>::build(std::vector<T> &elements, size_t lo, size_t hi) {
+
+    // elements[lo, hi) are sorted, the middle one becomes the subtree root
+    if(lo >= hi)
+        return nullptr;
+
+    // the guard frees the subtree built so far if a later allocation throws
+    size_t mid = lo + (hi - lo) / 2;
+    std::unique_ptr<AVL_Node<T>> node(new AVL_Node<T>(std::move(elements[mid])));
+    node->left  = build(elements, lo, mid);
+    node->right = build(elements, mid + 1, hi);
+    node->update();
+    return node.release();
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,762 @@
+#pragma once
+
+#include "../element.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* Declaration */
+namespace ds_imp {
+
+template <typename T>
+struct BPlus_Node {
+    bool is_leaf;
+    uint16_t num_keys;
+
+    static constexpr size_t NODE_BYTES = 256;  // 4 cache lines
+    static constexpr size_t HEADER_BYTES = 8;
+
+    BPlus_Node(bool is_leaf) : is_leaf(is_leaf), num_keys(0) {}
+};
+
+template <typename T>
+struct alignas(64) BPlus_Inner : BPlus_Node<T> {
+
+    static constexpr size_t MAX_KEYS = std::max<size_t>(
+        3, (BPlus_Node<T>::NODE_BYTES - BPlus_Node<T>::HEADER_BYTES - sizeof(void*)) / (sizeof(T) + sizeof(void*))
+    );
+    static constexpr size_t MIN_KEYS = MAX_KEYS / 2;
+
+    T keys[MAX_KEYS];                         // keys[i] <= every key under children[i + 1]
+    BPlus_Node<T> *children[MAX_KEYS + 1];
+
+    BPlus_Inner() : BPlus_Node<T>(false) {}
+};
+
+template <typename T>
+struct alignas(64) BPlus_Leaf : BPlus_Node<T> {
+
+    static constexpr size_t MAX_KEYS = std::max<size_t>(
+        3, (BPlus_Node<T>::NODE_BYTES - BPlus_Node<T>::HEADER_BYTES - 2 * sizeof(void*)) / sizeof(T)
+    );
+    static constexpr size_t MIN_KEYS = MAX_KEYS / 2;
+
+    T keys[MAX_KEYS];
+    BPlus_Leaf<T> *prev;
+    BPlus_Leaf<T> *next;
+
+    BPlus_Leaf() : BPlus_Node<T>(true), prev(nullptr), next(nullptr) {}
+};
+
+namespace detail {
+
+// rank of ele among the sorted keys of one node, shared with Disk_BTree
+template <typename T>
+size_t bplus_count_less(const T *keys, size_t n, const T &ele);
+
+template <typename T>
+size_t bplus_count_less_equal(const T *keys, size_t n, const T &ele);
+
+}
+
+template <typename T>
+class BPlus_Tree {
+
+    using Node  = BPlus_Node<T>;
+    using Inner = BPlus_Inner<T>;
+    using Leaf  = BPlus_Leaf<T>;
+    using Result = std::variant<std::nullptr_t, T>;
+
+    public:
+        BPlus_Tree();
+        template <typename Iter>
+        BPlus_Tree(Iter first, Iter last);
+        ~BPlus_Tree();
+
+        Result get_min() const;
+        Result get_max() const;
+        Result search_node(const T &ele) const;
+        Result lower_bound(const T &ele) const;
+        void insert_node(const T  &ele);
+        void insert_node(T &&ele);
+        void delete_node(const T ele);
+        void modify_node(const T &ele, const T &new_ele);
+        void modify_node(const T &ele, const T &&new_ele);
+        template <typename Func>
+        void for_each_in_range(const T &lo, const T &hi, Func fn) const;
+        void inorder(std::ostream &os);
+        void show(std::ostream &os);
+        void clear();
+        inline bool empty() const;
+        inline size_t size() const;
+        inline size_t height() const;
+
+        static const size_t MAX_HEIGHT = 64;
+
+    private:
+        Node *root;
+        Leaf *first_leaf;
+        Leaf *last_leaf;
+        size_t num_nodes;
+        size_t num_levels;
+
+        Leaf* find_leaf(const T &ele, Inner** path, size_t* index, size_t &depth) const;
+        template <typename U>
+        void insert_impl(U &&ele);
+        void insert_parent(Inner** path, size_t* index, size_t depth, T separator, Node* right);
+        void fix_leaf(Leaf* leaf, Inner** path, size_t* index, size_t depth);
+        void fix_inner(Inner* node, Inner** path, size_t* index, size_t depth);
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+namespace detail {
+
+template <typename T>
+size_t bplus_count_less(const T *keys, size_t n, const T &ele) {
+
+    // the number of keys < ele, keys are sorted
+#if defined(__SSE2__)
+    if constexpr (std::is_same_v<T, int32_t> || std::is_same_v<T, Element>) {
+        static_assert(sizeof(T) == sizeof(int32_t));
+
+        const int32_t *raw = reinterpret_cast<const int32_t*>(keys);
+        int32_t value = reinterpret_cast<const int32_t&>(ele);
+        __m128i target = _mm_set1_epi32(value);
+        size_t count = 0, i = 0;
+
+        for(; i + 4 <= n; i += 4) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(block, target)));
+            count += __builtin_popcount(mask);
+        }
+        for(; i < n; ++i)
+            count += (raw[i] < value);
+        return count;
+    }
+#endif
+    size_t count = 0;
+    for(size_t i = 0; i < n; ++i)
+        count += (keys[i] < ele);
+    return count;
+}
+
+template <typename T>
+size_t bplus_count_less_equal(const T *keys, size_t n, const T &ele) {
+
+    // the number of keys <= ele, keys are sorted
+#if defined(__SSE2__)
+    if constexpr (std::is_same_v<T, int32_t> || std::is_same_v<T, Element>) {
+        const int32_t *raw = reinterpret_cast<const int32_t*>(keys);
+        int32_t value = reinterpret_cast<const int32_t&>(ele);
+        __m128i target = _mm_set1_epi32(value);
+        size_t count = 0, i = 0;
+
+        for(; i + 4 <= n; i += 4) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(raw + i));
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(block, target)));
+            count += 4 - __builtin_popcount(mask);
+        }
+        for(; i < n; ++i)
+            count += (raw[i] <= value);
+        return count;
+    }
+#endif
+    size_t count = 0;
+    for(size_t i = 0; i < n; ++i)
+        count += (keys[i] <= ele);
+    return count;
+}
+
+}
+
+/* BPlus_Tree */
+template <typename T>
+BPlus_Tree<T>::BPlus_Tree()
+    : root(nullptr),
+      first_leaf(nullptr),
+      last_leaf(nullptr),
+      num_nodes(0),
+      num_levels(0) {}
+
+template <typename T>
+template <typename Iter>
+BPlus_Tree<T>::BPlus_Tree(Iter first, Iter last) : BPlus_Tree() {
+
+    // bulk loading: spread the sorted keys evenly over the fewest leaves, then build each level above
+    std::vector<T> elements(first, last);
+    if(!std::is_sorted(elements.begin(), elements.end()))
+        std::sort(elements.begin(), elements.end());
+
+    if(std::adjacent_find(elements.begin(), elements.end()) != elements.end()) {
+        throw std::runtime_error("The element has been in the BPlus_Tree");
+    }
+
+    if(elements.empty())
+        return;
+
+    size_t n = elements.size(), num_leaves = (n + Leaf::MAX_KEYS - 1) / Leaf::MAX_KEYS;
+    std::vector<Node*> level;
+    std::vector<T> low_keys;  // the smallest key under each node of the level
+    level.reserve(num_leaves);
+    low_keys.reserve(num_leaves);
+
+    size_t pos = 0;
+    Leaf *prev = nullptr;
+    for(size_t i = 0; i < num_leaves; ++i) {
+        size_t count = n / num_leaves + ((i < n % num_leaves) ? (1) : (0));
+        Leaf *leaf = new Leaf();
+
+        for(size_t j = 0; j < count; ++j)
+            leaf->keys[j] = std::move(elements[pos++]);
+        leaf->num_keys = static_cast<uint16_t>(count);
+        leaf->prev = prev;
+        if(prev != nullptr) prev->next = leaf;
+        else                first_leaf = leaf;
+        prev = leaf;
+
+        level.push_back(leaf);
+        low_keys.push_back(leaf->keys[0]);
+    }
+    last_leaf = prev;
+    num_levels = 1;
+
+    while(level.size() > 1) {
+        size_t num_children = level.size(), num_groups = (num_children + Inner::MAX_KEYS) / (Inner::MAX_KEYS + 1);
+        std::vector<Node*> upper;
+        std::vector<T> upper_keys;
+
+        pos = 0;
+        for(size_t i = 0; i < num_groups; ++i) {
+            size_t count = num_children / num_groups + ((i < num_children % num_groups) ? (1) : (0));
+            Inner *node = new Inner();
+
+            upper_keys.push_back(low_keys[pos]);
+            for(size_t j = 0; j < count; ++j, ++pos) {
+                node->children[j] = level[pos];
+                if(j > 0) node->keys[j - 1] = low_keys[pos];
+            }
+            node->num_keys = static_cast<uint16_t>(count - 1);
+            upper.push_back(node);
+        }
+
+        level.swap(upper);
+        low_keys.swap(upper_keys);
+        num_levels ++;
+    }
+
+    root = level[0];
+    num_nodes = n;
+}
+
+template <typename T>
+BPlus_Tree<T>::~BPlus_Tree() {
+    clear();
+}
+
+template <typename T>
+BPlus_Tree<T>::Result BPlus_Tree<T>::get_min() const {
+
+    if(empty())
+        return nullptr;
+    return first_leaf->keys[0];
+}
+
+template <typename T>
+BPlus_Tree<T>::Result BPlus_Tree<T>::get_max() const {
+
+    if(empty())
+        return nullptr;
+    return last_leaf->keys[last_leaf->num_keys - 1];
+}
+
+template <typename T>
+BPlus_Tree<T>::Result BPlus_Tree<T>::search_node(const T &ele) const {
+
+    Inner *path[MAX_HEIGHT];
+    size_t index[MAX_HEIGHT], depth = 0;
+
+    Leaf *leaf = find_leaf(ele, path, index, depth);
+    if(leaf == nullptr)
+        return nullptr;
+
+    size_t pos = detail::bplus_count_less(leaf->keys, leaf->num_keys, ele);
+    if(pos < leaf->num_keys && leaf->keys[pos] == ele)
+        return leaf->keys[pos];
+    return nullptr;
+}
+
+template <typename T>
+BPlus_Tree<T>::Result BPlus_Tree<T>::lower_bound(const T &ele) const {
+
+    // the first element >= ele
+    Inner *path[MAX_HEIGHT];
+    size_t index[MAX_HEIGHT], depth = 0;
+
+    Leaf *leaf = find_leaf(ele, path, index, depth);
+    if(leaf == nullptr)
+        return nullptr;
+
+    size_t pos = detail::bplus_count_less(leaf->keys, leaf->num_keys, ele);
+    if(pos == leaf->num_keys) {
+        leaf = leaf->next;
+        pos = 0;
+    }
+
+    if(leaf == nullptr)
+        return nullptr;
+    return leaf->keys[pos];
+}
+
+template <typename T>
+void BPlus_Tree<T>::insert_node(const T &ele) {
+    insert_impl(ele);
+}
+
+template <typename T>
+void BPlus_Tree<T>::insert_node(T &&ele) {
+    insert_impl(std::move(ele));
+}
+
+template <typename T>
+void BPlus_Tree<T>::delete_node(const T ele) {
+
+    Inner *path[MAX_HEIGHT];
+    size_t index[MAX_HEIGHT], depth = 0;
+
+    Leaf *leaf = find_leaf(ele, path, index, depth);
+    if(leaf == nullptr)
+        return;
+
+    size_t pos = detail::bplus_count_less(leaf->keys, leaf->num_keys, ele);
+    if(pos == leaf->num_keys || leaf->keys[pos] != ele)
+        return; // Not found
+
+    for(size_t i = pos; i + 1 < leaf->num_keys; ++i)
+        leaf->keys[i] = std::move(leaf->keys[i + 1]);
+    leaf->num_keys --;
+    num_nodes --;
+
+    fix_leaf(leaf, path, index, depth);
+}
+
+template <typename T>
+void BPlus_Tree<T>::modify_node(const T &ele, const T &new_ele) {
+
+    delete_node(ele);
+    insert_node(new_ele);
+}
+
+template <typename T>
+void BPlus_Tree<T>::modify_node(const T &ele, const T &&new_ele) {
+
+    delete_node(ele);
+    insert_node(std::move(new_ele));
+}
+
+template <typename T>
+template <typename Func>
+void BPlus_Tree<T>::for_each_in_range(const T &lo, const T &hi, Func fn) const {
+
+    // one descent to the first leaf, then a sequential scan along the leaf links
+    Inner *path[MAX_HEIGHT];
+    size_t index[MAX_HEIGHT], depth = 0;
+
+    Leaf *leaf = find_leaf(lo, path, index, depth);
+    if(leaf == nullptr)
+        return;
+
+    size_t pos = detail::bplus_count_less(leaf->keys, leaf->num_keys, lo);
+    while(leaf != nullptr) {
+        for(; pos < leaf->num_keys; ++pos) {
+            if(hi < leaf->keys[pos])
+                return;
+            fn(leaf->keys[pos]);
+        }
+        leaf = leaf->next;
+        pos = 0;
+    }
+}
+
+template <typename T>
+void BPlus_Tree<T>::inorder(std::ostream &os) {
+
+    for(Leaf *leaf = first_leaf; leaf != nullptr; leaf = leaf->next) {
+        for(size_t i = 0; i < leaf->num_keys; ++i)
+            os << leaf->keys[i] << ", ";
+    }
+    os << std::endl;
+}
+
+template <typename T>
+void BPlus_Tree<T>::show(std::ostream &os) {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Height: " << std::setw(4) << height() << ", ";
+    os << "Inner keys: " << Inner::MAX_KEYS << ", ";
+    os << "Leaf keys: "  << Leaf::MAX_KEYS << std::endl;
+
+    if(root == nullptr)
+        return;
+
+    // one line per level
+    std::queue<Node*> nodes;
+    nodes.push(root);
+
+    while(!nodes.empty()) {
+        size_t count = nodes.size();
+        bool is_leaf = nodes.front()->is_leaf;
+        os << ((is_leaf) ? ("Leaves: ") : ("Inner: "));
+
+        for(size_t i = 0; i < count; ++i) {
+            Node *node = nodes.front();
+            nodes.pop();
+
+            const T *keys = (node->is_leaf) ? (static_cast<Leaf*>(node)->keys) : (static_cast<Inner*>(node)->keys);
+            os << "[";
+            for(size_t j = 0; j < node->num_keys; ++j)
+                os << keys[j] << ((j + 1 < node->num_keys) ? (" ") : (""));
+            os << "] ";
+
+            if(!node->is_leaf) {
+                Inner *inner = static_cast<Inner*>(node);
+                for(size_t j = 0; j <= inner->num_keys; ++j)
+                    nodes.push(inner->children[j]);
+            }
+        }
+        os << std::endl;
+    }
+}
+
+template <typename T>
+void BPlus_Tree<T>::clear() {
+
+    // free level by level with an explicit stack
+    std::vector<Node*> nodes;
+    if(root != nullptr) nodes.push_back(root);
+
+    while(!nodes.empty()) {
+        Node *node = nodes.back();
+        nodes.pop_back();
+
+        if(node->is_leaf) {
+            delete static_cast<Leaf*>(node);
+            continue;
+        }
+
+        Inner *inner = static_cast<Inner*>(node);
+        for(size_t i = 0; i <= inner->num_keys; ++i)
+            nodes.push_back(inner->children[i]);
+        delete inner;
+    }
+
+    root = nullptr;
+    first_leaf = last_leaf = nullptr;
+    num_nodes = num_levels = 0;
+}
+
+template <typename T>
+inline bool BPlus_Tree<T>::empty() const {
+    return (size() == 0);
+}
+
+template <typename T>
+inline size_t BPlus_Tree<T>::size() const {
+    return num_nodes;
+}
+
+template <typename T>
+inline size_t BPlus_Tree<T>::height() const {
+    return num_levels;
+}
+
+template <typename T>
+BPlus_Tree<T>::Leaf* BPlus_Tree<T>::find_leaf(const T &ele, Inner** path, size_t* index, size_t &depth) const {
+
+    // record every inner node on the way down and the child taken from it
+    Node *curr = root;
+    while(curr != nullptr && !curr->is_leaf) {
+        Inner *inner = static_cast<Inner*>(curr);
+        size_t idx = detail::bplus_count_less_equal(inner->keys, inner->num_keys, ele);
+
+        path[depth] = inner;
+        index[depth ++] = idx;
+        curr = inner->children[idx];
+    }
+    return static_cast<Leaf*>(curr);
+}
+
+template <typename T>
+template <typename U>
+void BPlus_Tree<T>::insert_impl(U &&ele) {
+
+    if(root == nullptr) {
+        Leaf *leaf = new Leaf();
+        leaf->keys[0] = std::forward<U>(ele);
+        leaf->num_keys = 1;
+        root = first_leaf = last_leaf = leaf;
+        num_nodes = num_levels = 1;
+        return;
+    }
+
+    Inner *path[MAX_HEIGHT];
+    size_t index[MAX_HEIGHT], depth = 0;
+
+    Leaf *leaf = find_leaf(ele, path, index, depth);
+    size_t pos = detail::bplus_count_less(leaf->keys, leaf->num_keys, ele);
+
+    if(pos < leaf->num_keys && leaf->keys[pos] == ele) {
+        throw std::runtime_error("The element has been in the BPlus_Tree");
+    }
+
+    num_nodes ++;
+    if(leaf->num_keys < Leaf::MAX_KEYS) {
+        for(size_t i = leaf->num_keys; i > pos; --i)
+            leaf->keys[i] = std::move(leaf->keys[i - 1]);
+        leaf->keys[pos] = std::forward<U>(ele);
+        leaf->num_keys ++;
+        return;
+    }
+
+    // split a full leaf: the upper half moves to a new right sibling
+    T temp[Leaf::MAX_KEYS + 1];
+    for(size_t i = 0, j = 0; i <= Leaf::MAX_KEYS; ++i)
+        temp[i] = (i == pos) ? (T(std::forward<U>(ele))) : (std::move(leaf->keys[j++]));
+
+    Leaf *right = new Leaf();
+    size_t total = Leaf::MAX_KEYS + 1, left_count = total / 2;
+
+    for(size_t i = 0; i < left_count; ++i)
+        leaf->keys[i] = std::move(temp[i]);
+    for(size_t i = left_count; i < total; ++i)
+        right->keys[i - left_count] = std::move(temp[i]);
+    leaf->num_keys  = static_cast<uint16_t>(left_count);
+    right->num_keys = static_cast<uint16_t>(total - left_count);
+
+    right->next = leaf->next;
+    right->prev = leaf;
+    if(leaf->next != nullptr) leaf->next->prev = right;
+    else                      last_leaf = right;
+    leaf->next = right;
+
+    insert_parent(path, index, depth, right->keys[0], right);
+}
+
+template <typename T>
+void BPlus_Tree<T>::insert_parent(Inner** path, size_t* index, size_t depth, T separator, Node* right) {
+
+    while(depth > 0) {
+        Inner *parent = path[depth - 1];
+        size_t pos = index[depth - 1];
+        depth --;
+
+        if(parent->num_keys < Inner::MAX_KEYS) {
+            for(size_t i = parent->num_keys; i > pos; --i) {
+                parent->keys[i] = std::move(parent->keys[i - 1]);
+                parent->children[i + 1] = parent->children[i];
+            }
+            parent->keys[pos] = std::move(separator);
+            parent->children[pos + 1] = right;
+            parent->num_keys ++;
+            return;
+        }
+
+        // split a full inner node, the middle key moves up
+        T temp_keys[Inner::MAX_KEYS + 1];
+        Node *temp_children[Inner::MAX_KEYS + 2];
+
+        for(size_t i = 0, j = 0; i <= Inner::MAX_KEYS; ++i)
+            temp_keys[i] = (i == pos) ? (std::move(separator)) : (std::move(parent->keys[j++]));
+        for(size_t i = 0, j = 0; i <= Inner::MAX_KEYS + 1; ++i)
+            temp_children[i] = (i == pos + 1) ? (right) : (parent->children[j++]);
+
+        size_t total = Inner::MAX_KEYS + 1, mid = total / 2;
+        Inner *sibling = new Inner();
+
+        for(size_t i = 0; i < mid; ++i) {
+            parent->keys[i] = std::move(temp_keys[i]);
+            parent->children[i] = temp_children[i];
+        }
+        parent->children[mid] = temp_children[mid];
+        parent->num_keys = static_cast<uint16_t>(mid);
+
+        for(size_t i = mid + 1; i < total; ++i) {
+            sibling->keys[i - mid - 1] = std::move(temp_keys[i]);
+            sibling->children[i - mid - 1] = temp_children[i];
+        }
+        sibling->children[total - mid - 1] = temp_children[total];
+        sibling->num_keys = static_cast<uint16_t>(total - mid - 1);
+
+        separator = std::move(temp_keys[mid]);
+        right = sibling;
+    }
+
+    // the root has been split
+    Inner *new_root = new Inner();
+    new_root->keys[0] = std::move(separator);
+    new_root->children[0] = root;
+    new_root->children[1] = right;
+    new_root->num_keys = 1;
+    root = new_root;
+    num_levels ++;
+}
+
+template <typename T>
+void BPlus_Tree<T>::fix_leaf(Leaf* leaf, Inner** path, size_t* index, size_t depth) {
+
+    if(depth == 0) {
+        if(leaf->num_keys == 0) {
+            delete leaf;
+            root = first_leaf = last_leaf = nullptr;
+            num_levels = 0;
+        }
+        return;
+    }
+
+    if(leaf->num_keys >= Leaf::MIN_KEYS)
+        return;
+
+    Inner *parent = path[depth - 1];
+    size_t idx = index[depth - 1];
+    Leaf *left  = (idx > 0) ? (static_cast<Leaf*>(parent->children[idx - 1])) : (nullptr);
+    Leaf *right = (idx < parent->num_keys) ? (static_cast<Leaf*>(parent->children[idx + 1])) : (nullptr);
+
+    if(left != nullptr && left->num_keys > Leaf::MIN_KEYS) {
+        // borrow the largest key of the left sibling
+        for(size_t i = leaf->num_keys; i > 0; --i)
+            leaf->keys[i] = std::move(leaf->keys[i - 1]);
+        leaf->keys[0] = std::move(left->keys[left->num_keys - 1]);
+        leaf->num_keys ++;
+        left->num_keys --;
+        parent->keys[idx - 1] = leaf->keys[0];
+        return;
+    }
+
+    if(right != nullptr && right->num_keys > Leaf::MIN_KEYS) {
+        // borrow the smallest key of the right sibling
+        leaf->keys[leaf->num_keys ++] = std::move(right->keys[0]);
+        for(size_t i = 0; i + 1 < right->num_keys; ++i)
+            right->keys[i] = std::move(right->keys[i + 1]);
+        right->num_keys --;
+        parent->keys[idx] = right->keys[0];
+        return;
+    }
+
+    // merge with a sibling, the right one of the pair is freed
+    if(left == nullptr) {
+        left = leaf;
+        leaf = right;
+        idx ++;
+    }
+
+    for(size_t i = 0; i < leaf->num_keys; ++i)
+        left->keys[left->num_keys + i] = std::move(leaf->keys[i]);
+    left->num_keys += leaf->num_keys;
+
+    left->next = leaf->next;
+    if(leaf->next != nullptr) leaf->next->prev = left;
+    else                      last_leaf = left;
+    delete leaf;
+
+    for(size_t i = idx - 1; i + 1 < parent->num_keys; ++i) {
+        parent->keys[i] = std::move(parent->keys[i + 1]);
+        parent->children[i + 1] = parent->children[i + 2];
+    }
+    parent->num_keys --;
+
+    fix_inner(parent, path, index, depth - 1);
+}
+
+template <typename T>
+void BPlus_Tree<T>::fix_inner(Inner* node, Inner** path, size_t* index, size_t depth) {
+
+    while(true) {
+        if(depth == 0) {
+            if(node->num_keys == 0) {
+                root = node->children[0];
+                delete node;
+                num_levels --;
+            }
+            return;
+        }
+
+        if(node->num_keys >= Inner::MIN_KEYS)
+            return;
+
+        Inner *parent = path[depth - 1];
+        size_t idx = index[depth - 1];
+        Inner *left  = (idx > 0) ? (static_cast<Inner*>(parent->children[idx - 1])) : (nullptr);
+        Inner *right = (idx < parent->num_keys) ? (static_cast<Inner*>(parent->children[idx + 1])) : (nullptr);
+
+        if(left != nullptr && left->num_keys > Inner::MIN_KEYS) {
+            // rotate through the parent: the separator comes down, the left's last key goes up
+            for(size_t i = node->num_keys; i > 0; --i)
+                node->keys[i] = std::move(node->keys[i - 1]);
+            for(size_t i = node->num_keys + 1; i > 0; --i)
+                node->children[i] = node->children[i - 1];
+
+            node->keys[0] = std::move(parent->keys[idx - 1]);
+            node->children[0] = left->children[left->num_keys];
+            parent->keys[idx - 1] = std::move(left->keys[left->num_keys - 1]);
+            node->num_keys ++;
+            left->num_keys --;
+            return;
+        }
+
+        if(right != nullptr && right->num_keys > Inner::MIN_KEYS) {
+            node->keys[node->num_keys] = std::move(parent->keys[idx]);
+            node->children[node->num_keys + 1] = right->children[0];
+            parent->keys[idx] = std::move(right->keys[0]);
+            node->num_keys ++;
+
+            for(size_t i = 0; i + 1 < right->num_keys; ++i)
+                right->keys[i] = std::move(right->keys[i + 1]);
+            for(size_t i = 0; i < right->num_keys; ++i)
+                right->children[i] = right->children[i + 1];
+            right->num_keys --;
+            return;
+        }
+
+        // merge with a sibling, the separator comes down between them
+        if(left == nullptr) {
+            left = node;
+            node = right;
+            idx ++;
+        }
+
+        size_t base = left->num_keys;
+        left->keys[base] = std::move(parent->keys[idx - 1]);
+        for(size_t i = 0; i < node->num_keys; ++i)
+            left->keys[base + 1 + i] = std::move(node->keys[i]);
+        for(size_t i = 0; i <= node->num_keys; ++i)
+            left->children[base + 1 + i] = node->children[i];
+        left->num_keys += node->num_keys + 1;
+        delete node;
+
+        for(size_t i = idx - 1; i + 1 < parent->num_keys; ++i) {
+            parent->keys[i] = std::move(parent->keys[i + 1]);
+            parent->children[i + 1] = parent->children[i + 2];
+        }
+        parent->num_keys --;
+
+        node = parent;
+        depth --;
+    }
+}
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "eytzinger_tree.hpp"
 #include <cstdint>
 #include <cassert>
 #include <stdexcept>
@@ -7,6 +8,11 @@
 #include <iomanip>
 #include <utility>
 #include <variant>
+#include <iterator>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <stack>
 
 /* Declaration */
 namespace ds_imp {
@@ -16,6 +22,7 @@ struct BST_Node {
     T element;
     BST_Node<T> *left;
     BST_Node<T> *right;
+    BST_Node<T> *parent;
 
     /* Constructor */
     BST_Node(const T &ele = T(), BST_Node<T>* left = nullptr, BST_Node<T>* right = nullptr);
@@ -24,11 +31,39 @@ struct BST_Node {
     /* Destructor */
     ~BST_Node();
 
+    static void release(BST_Node<T>* node);
+
     void preorder(std::ostream &os);
     void inorder(std::ostream &os);
     void postorder(std::ostream &os);
 };
 
+template <typename T>
+class BST_Iterator {
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const T*;
+        using reference         = const T&;
+
+        BST_Iterator(BST_Node<T>* root = nullptr, BST_Node<T>* curr = nullptr);
+
+        reference operator*()  const;
+        pointer   operator->() const;
+        BST_Iterator<T>& operator++();
+        BST_Iterator<T>  operator++(int);
+        BST_Iterator<T>& operator--();
+        BST_Iterator<T>  operator--(int);
+        bool operator==(const BST_Iterator<T> &other) const;
+        bool operator!=(const BST_Iterator<T> &other) const;
+
+    private:
+        BST_Node<T> *root;
+        BST_Node<T> *curr;  // nullptr is end()
+};
+
 template <typename T> 
 class BST {
 
@@ -36,7 +71,11 @@ class BST {
     using Result = std::variant<std::nullptr_t, T>;
 
     public:
+        using iterator = BST_Iterator<T>;
+
         BST();
+        template <typename Iter>
+        BST(Iter first, Iter last);
         ~BST();
 
         Result get_min();
@@ -52,12 +91,24 @@ class BST {
         void postorder(std::ostream &os);
         bool empty() const;
         size_t size() const;
+        iterator begin() const;
+        iterator end() const;
+        iterator lower_bound(const T &ele) const;
+        iterator upper_bound(const T &ele) const;
+        std::pair<iterator, iterator> equal_range(const T &ele) const;
+        template <typename Func>
+        void for_each_in_range(const T &lo, const T &hi, Func fn) const;
+        Eytzinger_Tree<T> freeze() const;
     
     private:
         BST_Node<T> *root;
         BST_Node<T> *max_ptr;
         BST_Node<T> *min_ptr;
         size_t num_nodes;
+
+        void update_min_ptr();
+        void update_max_ptr();
+        BST_Node<T>* build(std::vector<T> &elements, size_t lo, size_t hi);
 };
 
 }
@@ -68,41 +119,178 @@ namespace ds_imp {
 /* BST_Node */
 template <typename T>
 BST_Node<T>::BST_Node(const T &ele, BST_Node<T>* left, BST_Node<T>* right) 
-    : element(ele), left(left), right(right) {}
+    : element(ele), left(left), right(right), parent(nullptr) {}
 
 template <typename T>
 BST_Node<T>::BST_Node(T &&ele, BST_Node<T>* left, BST_Node<T>* right) 
-    : element(std::move(ele)), left(left), right(right) {}
+    : element(std::move(ele)), left(left), right(right), parent(nullptr) {}
 
 template <typename T>
 BST_Node<T>::~BST_Node() {
 
-    if( left != nullptr)  delete left;
-    if(right != nullptr)  delete right;
+    // iterative destruction
+    release(left);
+    release(right);
+}
+
+template <typename T>
+void BST_Node<T>::release(BST_Node<T>* node) {
+
+    // rotate left children up until the subtree becomes a right chain, then free the chain
+    BST_Node<T> *temp = nullptr;
+    while(node != nullptr) {
+        if(node->left != nullptr) {
+            temp = node->left;
+            node->left = temp->right;
+            temp->right = node;
+            node = temp;
+        }
+        else {
+            temp = node->right;
+            node->right = nullptr;
+            delete node;
+            node = temp;
+        }
+    }
 }
 
 template <typename T>
 void BST_Node<T>::preorder(std::ostream &os) {
     
-    os << element << ", ";
-    if( left != nullptr) left->preorder(os);
-    if(right != nullptr) right->preorder(os);
+    std::stack<BST_Node<T>*> nodes;
+    nodes.push(this);
+
+    while(!nodes.empty()) {
+        decltype(this) curr = nodes.top();
+        nodes.pop();
+
+        os << curr->element << ", ";
+        if(curr->right != nullptr) nodes.push(curr->right);
+        if(curr-> left != nullptr) nodes.push(curr->left);
+    }
 }
 
 template <typename T>
 void BST_Node<T>::inorder(std::ostream &os) {
 
-    if( left != nullptr) left->inorder(os);
-    os << element << ", ";
-    if(right != nullptr) right->inorder(os);
+    std::stack<BST_Node<T>*> nodes;
+    decltype(this) curr = this;
+
+    while(curr != nullptr || !nodes.empty()) {
+        while(curr != nullptr) {
+            nodes.push(curr);
+            curr = curr->left;
+        }
+
+        curr = nodes.top();
+        nodes.pop();
+        os << curr->element << ", ";
+        curr = curr->right;
+    }
 }
 
 template <typename T>
 void BST_Node<T>::postorder(std::ostream &os) {
 
-    if( left != nullptr) left->postorder(os);
-    if(right != nullptr) right->postorder(os);
-    os << element << ", ";
+    std::stack<BST_Node<T>*> nodes;
+    decltype(this) curr = this, last = nullptr;
+
+    while(curr != nullptr || !nodes.empty()) {
+        if(curr != nullptr) {
+            nodes.push(curr);
+            curr = curr->left;
+            continue;
+        }
+
+        decltype(this) top = nodes.top();
+        if(top->right != nullptr && top->right != last) {
+            curr = top->right;
+        }
+        else {
+            os << top->element << ", ";
+            last = top;
+            nodes.pop();
+        }
+    }
+}
+
+/* BST_Iterator */
+template <typename T>
+BST_Iterator<T>::BST_Iterator(BST_Node<T>* root, BST_Node<T>* curr) 
+    : root(root), curr(curr) {}
+
+template <typename T>
+BST_Iterator<T>::reference BST_Iterator<T>::operator*() const {
+    return curr->element;
+}
+
+template <typename T>
+BST_Iterator<T>::pointer BST_Iterator<T>::operator->() const {
+    return &(curr->element);
+}
+
+template <typename T>
+BST_Iterator<T>& BST_Iterator<T>::operator++() {
+
+    assert(curr != nullptr);
+
+    if(curr->right != nullptr) {
+        curr = curr->right;
+        while(curr->left != nullptr) curr = curr->left;
+        return *this;
+    }
+
+    // the successor is the first ancestor reached from its left subtree
+    while(curr->parent != nullptr && curr->parent->right == curr) curr = curr->parent;
+    curr = curr->parent;
+    return *this;
+}
+
+template <typename T>
+BST_Iterator<T> BST_Iterator<T>::operator++(int) {
+
+    BST_Iterator<T> temp = *this;
+    ++(*this);
+    return temp;
+}
+
+template <typename T>
+BST_Iterator<T>& BST_Iterator<T>::operator--() {
+
+    if(curr == nullptr) {
+        curr = root;
+        while(curr != nullptr && curr->right != nullptr) curr = curr->right;
+        return *this;
+    }
+
+    if(curr->left != nullptr) {
+        curr = curr->left;
+        while(curr->right != nullptr) curr = curr->right;
+        return *this;
+    }
+
+    // the predecessor is the first ancestor reached from its right subtree
+    while(curr->parent != nullptr && curr->parent->left == curr) curr = curr->parent;
+    curr = curr->parent;
+    return *this;
+}
+
+template <typename T>
+BST_Iterator<T> BST_Iterator<T>::operator--(int) {
+
+    BST_Iterator<T> temp = *this;
+    --(*this);
+    return temp;
+}
+
+template <typename T>
+bool BST_Iterator<T>::operator==(const BST_Iterator<T> &other) const {
+    return curr == other.curr;
+}
+
+template <typename T>
+bool BST_Iterator<T>::operator!=(const BST_Iterator<T> &other) const {
+    return curr != other.curr;
 }
 
 /* BST */
@@ -113,6 +301,26 @@ BST<T>::BST()
       min_ptr(nullptr), 
       num_nodes(0) {}
 
+template <typename T> 
+template <typename Iter>
+BST<T>::BST(Iter first, Iter last) : BST() {
+
+    // bulk loading: sort the input if needed, then build a perfectly balanced tree in O(n)
+    std::vector<T> elements(first, last);
+    if(!std::is_sorted(elements.begin(), elements.end()))
+        std::sort(elements.begin(), elements.end());
+    
+    if(std::adjacent_find(elements.begin(), elements.end()) != elements.end()) {
+        throw std::runtime_error("The element has been in the BST");
+    }
+
+    root = build(elements, 0, elements.size());
+    num_nodes = elements.size();
+
+    update_max_ptr();
+    update_min_ptr();
+}
+
 template <typename T> 
 BST<T>::~BST() {
 
@@ -163,6 +371,7 @@ void BST<T>::insert_node(const T  &ele) {
 
     auto temp_node = new BST_Node<T>(ele);
     decltype(temp_node) parent = search_result.first;
+    temp_node->parent = parent;
 
     // second_result.first will be nullptr when empty() == true
     if(empty()) {
@@ -194,6 +403,7 @@ void BST<T>::insert_node(T &&ele) {
 
     auto temp_node = new BST_Node<T>(std::move(ele));
     decltype(temp_node) parent = search_result.first;
+    temp_node->parent = parent;
 
     // second_result.first will be nullptr when empty() == true
     if(empty()) {
@@ -242,21 +452,24 @@ void BST<T>::delete_node(const T &ele) {
         // successor don't have left child, but it may have right child.
         if(prev != nullptr) {
             prev->left = successor->right;
+            if(prev->left != nullptr) prev->left->parent = prev;
             successor->right = temp_node->right;
+            successor->right->parent = successor;
         }
         
         successor->left = temp_node->left;
+        successor->left->parent = successor;
         *ptr_addr = successor;
     }
+    if(*ptr_addr != nullptr) (*ptr_addr)->parent = search_result.first;
 
     num_nodes --;
     temp_node->left = temp_node->right = nullptr;
     delete temp_node;
 
     /* update min_ptr & max_ptr */
-    min_ptr = max_ptr = root;
-    while (min_ptr != nullptr && min_ptr->left ) min_ptr = min_ptr->left;
-    while (max_ptr != nullptr && max_ptr->right) max_ptr = max_ptr->right;
+    update_max_ptr();
+    update_min_ptr();
 
     return;
 }
@@ -299,6 +512,92 @@ void BST<T>::postorder(std::ostream &os) {
     os << std::endl;
 }
 
+template <typename T> 
+BST<T>::iterator BST<T>::begin() const {
+    return iterator(root, min_ptr);
+}
+
+template <typename T> 
+BST<T>::iterator BST<T>::end() const {
+    return iterator(root, nullptr);
+}
+
+template <typename T> 
+BST<T>::iterator BST<T>::lower_bound(const T &ele) const {
+
+    // the first element >= ele
+    BST_Node<T> *curr = root, *bound = nullptr;
+    while(curr != nullptr) {
+        if(curr->element < ele) curr = curr->right;
+        else                    { bound = curr; curr = curr->left; }
+    }
+    return iterator(root, bound);
+}
+
+template <typename T> 
+BST<T>::iterator BST<T>::upper_bound(const T &ele) const {
+
+    // the first element > ele
+    BST_Node<T> *curr = root, *bound = nullptr;
+    while(curr != nullptr) {
+        if(ele < curr->element) { bound = curr; curr = curr->left; }
+        else                    curr = curr->right;
+    }
+    return iterator(root, bound);
+}
+
+template <typename T> 
+std::pair<typename BST<T>::iterator, typename BST<T>::iterator> BST<T>::equal_range(const T &ele) const {
+    return {lower_bound(ele), upper_bound(ele)};
+}
+
+template <typename T> 
+template <typename Func>
+void BST<T>::for_each_in_range(const T &lo, const T &hi, Func fn) const {
+
+    // in-order walk over [lo, hi] that never descends into subtrees outside the range
+    std::stack<BST_Node<T>*> nodes;
+    BST_Node<T> *curr = root;
+
+    while(curr != nullptr || !nodes.empty()) {
+        while(curr != nullptr) {
+            if(curr->element < lo) {
+                curr = curr->right;
+            }
+            else {
+                nodes.push(curr);
+                curr = curr->left;
+            }
+        }
+
+        if(nodes.empty())
+            break;
+
+        curr = nodes.top();
+        nodes.pop();
+        if(hi < curr->element)
+            break;
+
+        fn(curr->element);
+        curr = curr->right;
+    }
+}
+
+template <typename T> 
+Eytzinger_Tree<T> BST<T>::freeze() const {
+
+    // read-only snapshot, later changes of the tree are not reflected
+    if(empty())
+        return Eytzinger_Tree<T>();
+
+    std::vector<T> elements;
+    elements.reserve(size());
+    for_each_in_range(min_ptr->element, max_ptr->element, [&](const T &ele) {
+        elements.push_back(ele);
+    });
+    return Eytzinger_Tree<T>(elements.begin(), elements.end());
+}
+
 template <typename T> 
 bool BST<T>::empty() const {
     return size() == 0;
@@ -309,4 +608,37 @@ size_t BST<T>::size() const {
     return num_nodes;
 }
 
+template <typename T> 
+BST_Node<T>* BST<T>::build(std::vector<T> &elements, size_t lo, size_t hi) {
+
+    // elements[lo, hi) are sorted, the middle one becomes the subtree root
+    if(lo >= hi)
+        return nullptr;
+
+    // the guard frees the subtree built so far if a later allocation throws
+    size_t mid = lo + (hi - lo) / 2;
+    std::unique_ptr<BST_Node<T>> node(new BST_Node<T>(std::move(elements[mid])));
+    node->left  = build(elements, lo, mid);
+    node->right = build(elements, mid + 1, hi);
+    if(node->left  != nullptr) node->left->parent  = node.get();
+    if(node->right != nullptr) node->right->parent = node.get();
+    return node.release();
+}
+
+template <typename T> 
+void BST<T>::update_min_ptr() {
+    min_ptr = root;
+    while (min_ptr != nullptr && min_ptr->left != nullptr) {
+        min_ptr = min_ptr->left;
+    }
+}
+
+template <typename T> 
+void BST<T>::update_max_ptr() {
+    max_ptr = root;
+    while (max_ptr != nullptr && max_ptr->right != nullptr) {
+        max_ptr = max_ptr->right;
+    }
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,512 @@
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <algorithm>
+
+/* Declaration */
+/* AVL tree stored in one array, linked by 32-bit indices */
+namespace ds_imp {
+
+template <typename T>
+struct Compact_AVL_Node {
+    T element;
+    uint32_t left;
+    uint32_t right;
+    uint8_t height;  // bf is derived from the heights of the children
+
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    /* Constructor */
+    Compact_AVL_Node(const T &ele = T(), uint32_t left = NIL, uint32_t right = NIL, uint8_t height = 1);
+    Compact_AVL_Node(T &&ele, uint32_t left = NIL, uint32_t right = NIL, uint8_t height = 1);
+};
+
+template <typename T>
+class Compact_AVL_Tree {
+
+    using Node = Compact_AVL_Node<T>;
+    using Pair_Result = std::pair<Node*, Node*>;
+    using Result = std::variant<std::nullptr_t, T>;
+
+    public:
+        Compact_AVL_Tree();
+        ~Compact_AVL_Tree();
+
+        Result get_min() const;
+        Result get_max() const;
+        Pair_Result search_node(const T &ele);
+        void insert_node(const T  &ele);
+        void insert_node(T &&ele);
+        void delete_node(const T ele);
+        void modify_node(const T &ele, const T &new_ele);
+        void modify_node(const T &ele, const T &&new_ele);
+        void preorder(std::ostream &os);
+        void inorder(std::ostream &os);
+        void postorder(std::ostream &os);
+        void show(std::ostream &os);
+        void reserve(size_t capacity);
+        void clear();
+        inline bool empty() const;
+        inline size_t size() const;
+        inline size_t height() const;
+
+        static constexpr uint32_t NIL = Node::NIL;
+        static constexpr size_t MAX_HEIGHT = 64;   // 1.44 * log2(2^32) < 64
+        static constexpr size_t MAX_NODES  = NIL - 1;
+
+    private:
+        std::vector<Node> nodes;
+        uint32_t root;
+        uint32_t max_idx;
+        uint32_t min_idx;
+        uint32_t free_head;  // freed slots are chained through their left index
+        size_t num_nodes;
+
+        template <typename U>
+        void insert_impl(U &&ele);
+        uint32_t alloc_node(T &&ele);
+        void free_node(uint32_t idx);
+        void retrace(uint32_t *path, size_t depth);
+
+        inline uint8_t height_of(uint32_t idx) const;
+        inline int32_t bf_of(uint32_t idx) const;
+        void update(uint32_t idx);
+        uint32_t rotate(uint32_t idx);
+        uint32_t left_rotate(uint32_t idx);
+        uint32_t right_rotate(uint32_t idx);
+        void update_min_idx();
+        void update_max_idx();
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+/* Compact_AVL_Node */
+template <typename T>
+Compact_AVL_Node<T>::Compact_AVL_Node(const T &ele, uint32_t left, uint32_t right, uint8_t height)
+    : element(ele), left(left), right(right), height(height) {}
+
+template <typename T>
+Compact_AVL_Node<T>::Compact_AVL_Node(T &&ele, uint32_t left, uint32_t right, uint8_t height)
+    : element(std::move(ele)), left(left), right(right), height(height) {}
+
+/* Compact_AVL_Tree */
+template <typename T>
+Compact_AVL_Tree<T>::Compact_AVL_Tree()
+    : root(NIL),
+      max_idx(NIL),
+      min_idx(NIL),
+      free_head(NIL),
+      num_nodes(0) {}
+
+template <typename T>
+Compact_AVL_Tree<T>::~Compact_AVL_Tree() = default;
+
+template <typename T>
+Compact_AVL_Tree<T>::Result Compact_AVL_Tree<T>::get_min() const {
+
+    if(empty())
+        return nullptr;
+    return nodes[min_idx].element;
+}
+
+template <typename T>
+Compact_AVL_Tree<T>::Result Compact_AVL_Tree<T>::get_max() const {
+
+    if(empty())
+        return nullptr;
+    return nodes[max_idx].element;
+}
+
+template <typename T>
+Compact_AVL_Tree<T>::Pair_Result Compact_AVL_Tree<T>::search_node(const T &ele) {
+
+    // the pointers are valid until the next insertion or deletion
+    uint32_t parent = NIL, curr = root;
+    while(curr != NIL && nodes[curr].element != ele) {
+
+        parent = curr;
+        if(nodes[curr].element < ele) curr = nodes[curr].right;
+        else                          curr = nodes[curr].left;
+    }
+
+    return {
+        (parent == NIL) ? (nullptr) : (&nodes[parent]),
+        (curr   == NIL) ? (nullptr) : (&nodes[curr])
+    };
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::insert_node(const T &ele) {
+    insert_impl(ele);
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::insert_node(T &&ele) {
+    insert_impl(std::move(ele));
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::delete_node(const T ele) {
+
+    uint32_t path[MAX_HEIGHT];
+    size_t depth = 0;
+    uint32_t curr = root, target = NIL;
+
+    while(curr != NIL) {
+        if(nodes[curr].element == ele) {
+            target = curr;
+            break;
+        }
+        path[depth++] = curr;
+        if(nodes[curr].element < ele) curr = nodes[curr].right;
+        else                          curr = nodes[curr].left;
+    }
+
+    if(target == NIL) return; // Not found
+
+    uint32_t removed = target, new_subtree = NIL;
+
+    if(nodes[target].left != NIL && nodes[target].right != NIL) {
+        // Two children: the successor takes the place of the target
+        path[depth++] = target;
+        removed = nodes[target].right;
+        while(nodes[removed].left != NIL) {
+            path[depth++] = removed;
+            removed = nodes[removed].left;
+        }
+        nodes[target].element = std::move(nodes[removed].element);
+    }
+
+    new_subtree = (nodes[removed].left != NIL) ? (nodes[removed].left) : (nodes[removed].right);
+
+    if(depth == 0)                                root = new_subtree;
+    else if(nodes[path[depth - 1]].left == removed) nodes[path[depth - 1]].left  = new_subtree;
+    else                                          nodes[path[depth - 1]].right = new_subtree;
+
+    free_node(removed);
+    retrace(path, depth);
+
+    num_nodes --;
+    update_max_idx();
+    update_min_idx();
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::modify_node(const T &ele, const T &new_ele) {
+
+    delete_node(ele);
+    insert_node(new_ele);
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::modify_node(const T &ele, const T &&new_ele) {
+
+    delete_node(ele);
+    insert_node(std::move(new_ele));
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::preorder(std::ostream &os) {
+
+    uint32_t stack[MAX_HEIGHT + 1];
+    size_t top = 0;
+    if(root != NIL) stack[top++] = root;
+
+    while(top > 0) {
+        const Node &curr = nodes[stack[--top]];
+
+        os << curr.element << ", ";
+        if(curr.right != NIL) stack[top++] = curr.right;
+        if(curr. left != NIL) stack[top++] = curr.left;
+    }
+    os << std::endl;
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::inorder(std::ostream &os) {
+
+    uint32_t stack[MAX_HEIGHT];
+    size_t top = 0;
+    uint32_t curr = root;
+
+    while(curr != NIL || top > 0) {
+        while(curr != NIL) {
+            stack[top++] = curr;
+            curr = nodes[curr].left;
+        }
+
+        curr = stack[--top];
+        os << nodes[curr].element << ", ";
+        curr = nodes[curr].right;
+    }
+    os << std::endl;
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::postorder(std::ostream &os) {
+
+    uint32_t stack[MAX_HEIGHT];
+    size_t top = 0;
+    uint32_t curr = root, last = NIL;
+
+    while(curr != NIL || top > 0) {
+        if(curr != NIL) {
+            stack[top++] = curr;
+            curr = nodes[curr].left;
+            continue;
+        }
+
+        uint32_t peek = stack[top - 1];
+        if(nodes[peek].right != NIL && nodes[peek].right != last) {
+            curr = nodes[peek].right;
+        }
+        else {
+            os << nodes[peek].element << ", ";
+            last = peek;
+            top --;
+        }
+    }
+    os << std::endl;
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::show(std::ostream &os) {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Height: " << std::setw(4) << height() << ", ";
+
+    os << "Max: ";
+    if(max_idx != NIL) os << std::setw(4) << nodes[max_idx].element << ", ";
+    else               os << "null, ";
+
+    os << "Min: ";
+    if(min_idx != NIL) os << std::setw(4) << nodes[min_idx].element << ", ";
+    else               os << "null, ";
+
+    os << std::endl;
+
+    uint32_t stack[MAX_HEIGHT + 1];
+    size_t top = 0;
+    if(root != NIL) stack[top++] = root;
+
+    while(top > 0) {
+        const Node &curr = nodes[stack[--top]];
+
+        os << "Node(" << static_cast<uint32_t>(curr.height) << "): "
+           << std::setw(4) << curr.element << ", ";
+
+        os << "Left: ";
+        if (curr.left == NIL) os << "null";
+        else                  os << std::setw(4) << nodes[curr.left].element;
+        os << ", ";
+
+        os << "Right: ";
+        if (curr.right == NIL) os << "null";
+        else                   os << std::setw(4) << nodes[curr.right].element;
+        os << std::endl;
+
+        if(curr.right != NIL) stack[top++] = curr.right;
+        if(curr. left != NIL) stack[top++] = curr.left;
+    }
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::reserve(size_t capacity) {
+
+    if(capacity > MAX_NODES) {
+        throw std::out_of_range("The capacity is out of range");
+    }
+    nodes.reserve(capacity);
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::clear() {
+
+    // all nodes live in one array, so there is nothing to unlink
+    nodes.clear();
+    root = max_idx = min_idx = free_head = NIL;
+    num_nodes = 0;
+}
+
+template <typename T>
+inline bool Compact_AVL_Tree<T>::empty() const {
+    return (size() == 0);
+}
+
+template <typename T>
+inline size_t Compact_AVL_Tree<T>::size() const {
+    return num_nodes;
+}
+
+template <typename T>
+size_t Compact_AVL_Tree<T>::height() const {
+    return height_of(root);
+}
+
+template <typename T>
+template <typename U>
+void Compact_AVL_Tree<T>::insert_impl(U &&ele) {
+
+    uint32_t path[MAX_HEIGHT];
+    size_t depth = 0;
+    uint32_t curr = root;
+
+    while(curr != NIL) {
+        if(nodes[curr].element == ele) {
+            throw std::runtime_error("The element has been in the Compact_AVL_Tree");
+        }
+        path[depth++] = curr;
+        if(nodes[curr].element < ele) curr = nodes[curr].right;
+        else                          curr = nodes[curr].left;
+    }
+
+    if(num_nodes >= MAX_NODES) {
+        throw std::runtime_error("The Compact_AVL_Tree is full");
+    }
+
+    uint32_t new_idx = alloc_node(T(std::forward<U>(ele)));
+
+    if(depth == 0)                                            root = new_idx;
+    else if(nodes[path[depth - 1]].element < nodes[new_idx].element) nodes[path[depth - 1]].right = new_idx;
+    else                                                      nodes[path[depth - 1]].left  = new_idx;
+
+    retrace(path, depth);
+
+    num_nodes ++;
+    update_max_idx();
+    update_min_idx();
+}
+
+template <typename T>
+uint32_t Compact_AVL_Tree<T>::alloc_node(T &&ele) {
+
+    if(free_head == NIL) {
+        nodes.emplace_back(std::move(ele));
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    uint32_t idx = free_head;
+    free_head = nodes[idx].left;
+    nodes[idx] = Node(std::move(ele));
+    return idx;
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::free_node(uint32_t idx) {
+
+    nodes[idx].left  = free_head;
+    nodes[idx].right = NIL;
+    free_head = idx;
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::retrace(uint32_t *path, size_t depth) {
+
+    // rebalance from the deepest ancestor up, stop once a subtree height is unchanged
+    while(depth > 0) {
+        uint32_t idx = path[--depth];
+        uint8_t old_height = nodes[idx].height;
+
+        update(idx);
+        uint32_t rotated = rotate(idx);
+
+        if(depth == 0)                             root = rotated;
+        else if(nodes[path[depth - 1]].left == idx) nodes[path[depth - 1]].left  = rotated;
+        else                                       nodes[path[depth - 1]].right = rotated;
+
+        if(rotated == idx && nodes[idx].height == old_height)
+            break;
+    }
+}
+
+template <typename T>
+inline uint8_t Compact_AVL_Tree<T>::height_of(uint32_t idx) const {
+    return (idx == NIL) ? (0) : (nodes[idx].height);
+}
+
+template <typename T>
+inline int32_t Compact_AVL_Tree<T>::bf_of(uint32_t idx) const {
+    return static_cast<int32_t>(height_of(nodes[idx].left)) - height_of(nodes[idx].right);
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::update(uint32_t idx) {
+    nodes[idx].height = std::max(height_of(nodes[idx].left), height_of(nodes[idx].right)) + 1;
+}
+
+template <typename T>
+uint32_t Compact_AVL_Tree<T>::rotate(uint32_t idx) {
+
+    int32_t bf = bf_of(idx);
+    if(-1 <= bf && bf <= 1)
+        return idx;
+
+    if     (bf >= 2 && bf_of(nodes[idx].left) >= 0)      { // LL
+        return right_rotate(idx);
+    }
+    else if(bf >= 2) /* left->bf < 0 */                  { // LR
+        nodes[idx].left = left_rotate(nodes[idx].left);
+        return right_rotate(idx);
+    }
+    else if(bf <= -2 && bf_of(nodes[idx].right) <= 0)    { // RR
+        return left_rotate(idx);
+    }
+    else/* (bf <= -2 && right->bf > 0) */                { // RL
+        nodes[idx].right = right_rotate(nodes[idx].right);
+        return left_rotate(idx);
+    }
+}
+
+template <typename T>
+uint32_t Compact_AVL_Tree<T>::left_rotate(uint32_t idx) {
+
+    assert(nodes[idx].right != NIL);
+
+    uint32_t ret_root = nodes[idx].right;
+    nodes[idx].right = nodes[ret_root].left;
+    nodes[ret_root].left = idx;
+    update(idx);
+    update(ret_root);
+    return ret_root;
+}
+
+template <typename T>
+uint32_t Compact_AVL_Tree<T>::right_rotate(uint32_t idx) {
+
+    assert(nodes[idx].left != NIL);
+
+    uint32_t ret_root = nodes[idx].left;
+    nodes[idx].left = nodes[ret_root].right;
+    nodes[ret_root].right = idx;
+    update(idx);
+    update(ret_root);
+    return ret_root;
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::update_min_idx() {
+    min_idx = root;
+    while (min_idx != NIL && nodes[min_idx].left != NIL) {
+        min_idx = nodes[min_idx].left;
+    }
+}
+
+template <typename T>
+void Compact_AVL_Tree<T>::update_max_idx() {
+    max_idx = root;
+    while (max_idx != NIL && nodes[max_idx].right != NIL) {
+        max_idx = nodes[max_idx].right;
+    }
+}
+
+}
@@ -0,0 +1,895 @@
+#pragma once
+
+#include "../element.hpp"
+#include "bplus_tree.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <variant>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Declaration */
+/* B+ tree of Element keys in a memory-mapped file, updated by copy-on-write */
+namespace ds_imp {
+
+inline constexpr size_t DISK_PAGE_SIZE = 4096;
+
+struct Disk_Page_Header {
+    uint64_t txid;      // the transaction that wrote the page, pages of the open transaction are written in place
+    uint32_t type;
+    uint32_t num_keys;
+};
+
+struct Disk_Leaf {
+    static constexpr size_t MAX_KEYS = (DISK_PAGE_SIZE - sizeof(Disk_Page_Header)) / sizeof(int32_t);
+    static constexpr size_t MIN_KEYS = MAX_KEYS / 2;
+
+    Disk_Page_Header header;
+    int32_t keys[MAX_KEYS];
+};
+
+struct Disk_Inner {
+    static constexpr size_t MAX_KEYS = (DISK_PAGE_SIZE - sizeof(Disk_Page_Header) - sizeof(uint64_t)) / (sizeof(int32_t) + sizeof(uint64_t));
+    static constexpr size_t MIN_KEYS = MAX_KEYS / 2;
+
+    Disk_Page_Header header;
+    int32_t keys[MAX_KEYS];                     // keys[i] <= every key under children[i + 1]
+    uint64_t children[MAX_KEYS + 1];
+};
+
+struct Disk_Free_List {
+    static constexpr size_t MAX_IDS = (DISK_PAGE_SIZE - sizeof(Disk_Page_Header) - sizeof(uint64_t)) / sizeof(uint64_t);
+
+    Disk_Page_Header header;
+    uint64_t next;
+    uint64_t ids[MAX_IDS];
+};
+
+struct Disk_Meta {
+    uint64_t magic;
+    uint64_t page_size;
+    uint64_t txid;
+    uint64_t root;
+    uint64_t num_pages;
+    uint64_t num_keys;
+    uint64_t height;
+    uint64_t free_head;
+    uint64_t checksum;
+};
+
+static_assert(sizeof(Disk_Leaf) <= DISK_PAGE_SIZE);
+static_assert(sizeof(Disk_Inner) <= DISK_PAGE_SIZE);
+static_assert(sizeof(Disk_Free_List) <= DISK_PAGE_SIZE);
+
+class Disk_BTree {
+
+    using Result = std::variant<std::nullptr_t, Element>;
+
+    public:
+        Disk_BTree(const std::string &path);
+        ~Disk_BTree();
+
+        Disk_BTree(const Disk_BTree &other) = delete;
+        Disk_BTree& operator=(const Disk_BTree &other) = delete;
+
+        Result get_min() const;
+        Result get_max() const;
+        Result search_node(const Element &ele) const;
+        Result lower_bound(const Element &ele) const;
+        void insert_node(const Element &ele);
+        void delete_node(const Element ele);
+        void modify_node(const Element &ele, const Element &new_ele);
+        template <typename Iter>
+        void bulk_load(Iter first, Iter last);
+        template <typename Func>
+        void for_each_in_range(const Element &lo, const Element &hi, Func fn) const;
+        void commit();
+        void inorder(std::ostream &os) const;
+        void show(std::ostream &os) const;
+        inline bool empty() const;
+        inline size_t size() const;
+        inline size_t height() const;
+
+        static constexpr uint64_t MAGIC = 0x45455254425F5344ULL;  // "DS_BTREE"
+        static constexpr uint64_t NIL = 0;                        // pages 0 and 1 hold the two meta slots
+        static constexpr size_t MAX_HEIGHT = 64;
+        static constexpr size_t INITIAL_PAGES = 16;
+
+        enum Page_Type : uint32_t { LEAF = 1, INNER = 2, FREE_LIST = 3 };
+
+    private:
+        int fd;
+        char *base;
+        size_t capacity;                  // pages mapped
+        uint64_t root;
+        uint64_t num_pages;               // pages in use, the rest of the mapping is spare
+        uint64_t num_keys;
+        uint64_t num_levels;
+        uint64_t committed_tx;
+        uint64_t curr_tx;
+        bool dirty;
+        std::vector<uint64_t> reusable;   // free in both meta slots, safe to overwrite
+        std::vector<uint64_t> pending;    // dropped by the open transaction, still reachable from the last commit
+        std::vector<uint64_t> list_pages; // the pages holding the committed free list
+
+        inline Disk_Page_Header* header(uint64_t id) const;
+        inline Disk_Leaf* leaf(uint64_t id) const;
+        inline Disk_Inner* inner(uint64_t id) const;
+        inline Disk_Meta* meta(uint64_t slot) const;
+
+        static uint64_t checksum(const Disk_Meta &m);
+        void map_file(size_t pages);
+        void ensure_capacity(size_t extra);
+        uint64_t allocate(uint32_t type);
+        uint64_t cow(uint64_t id);
+        void release(uint64_t id);
+        uint64_t find_leaf(int32_t key) const;
+        uint64_t cow_path(int32_t key, uint64_t* path, size_t* index, size_t &depth);
+        void insert_parent(uint64_t* path, size_t* index, size_t depth, int32_t separator, uint64_t right);
+        void fix_leaf(uint64_t id, uint64_t* path, size_t* index, size_t depth);
+        void fix_inner(uint64_t id, uint64_t* path, size_t* index, size_t depth);
+        void load_free_list(uint64_t head);
+        void write_meta();
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+inline Disk_BTree::Disk_BTree(const std::string &path)
+    : fd(-1),
+      base(nullptr),
+      capacity(0),
+      root(NIL),
+      num_pages(2),
+      num_keys(0),
+      num_levels(0),
+      committed_tx(0),
+      curr_tx(1),
+      dirty(false) {
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(fd < 0) {
+        throw std::runtime_error("Cannot open the Disk_BTree file");
+    }
+
+    // the destructor does not run for a constructor that throws, so the error path releases
+    // the mapping and the descriptor itself
+    try {
+        struct stat st;
+        if(::fstat(fd, &st) != 0 || st.st_size % DISK_PAGE_SIZE != 0) {
+            throw std::runtime_error("The Disk_BTree file is not page aligned");
+        }
+
+        if(st.st_size == 0) {
+            map_file(INITIAL_PAGES);
+            write_meta();
+            return;
+        }
+
+        map_file(st.st_size / DISK_PAGE_SIZE);
+
+        // recovery: the valid meta slot with the newest transaction wins
+        const Disk_Meta *best = nullptr;
+        for(uint64_t slot = 0; slot < 2; ++slot) {
+            const Disk_Meta *m = meta(slot);
+            if(m->magic != MAGIC || m->page_size != DISK_PAGE_SIZE || m->checksum != checksum(*m))
+                continue;
+            if(best == nullptr || m->txid > best->txid)
+                best = m;
+        }
+
+        if(best == nullptr || best->num_pages > capacity) {
+            throw std::runtime_error("The Disk_BTree file has no valid meta page");
+        }
+
+        root = best->root;
+        num_pages = best->num_pages;
+        num_keys = best->num_keys;
+        num_levels = best->height;
+        committed_tx = best->txid;
+        curr_tx = committed_tx + 1;
+        load_free_list(best->free_head);
+    }
+    catch(...) {
+        if(base != nullptr)
+            ::munmap(base, capacity * DISK_PAGE_SIZE);
+        ::close(fd);
+        throw;
+    }
+}
+
+inline Disk_BTree::~Disk_BTree() {
+
+    // an update that fails to commit here is simply lost, the last commit stays on disk
+    try { commit(); } catch(const std::runtime_error &) {}
+    ::munmap(base, capacity * DISK_PAGE_SIZE);
+    ::close(fd);
+}
+
+inline Disk_BTree::Result Disk_BTree::get_min() const {
+
+    if(empty())
+        return nullptr;
+
+    uint64_t id = root;
+    while(header(id)->type == INNER)
+        id = inner(id)->children[0];
+    return Element(leaf(id)->keys[0]);
+}
+
+inline Disk_BTree::Result Disk_BTree::get_max() const {
+
+    if(empty())
+        return nullptr;
+
+    uint64_t id = root;
+    while(header(id)->type == INNER)
+        id = inner(id)->children[inner(id)->header.num_keys];
+    return Element(leaf(id)->keys[leaf(id)->header.num_keys - 1]);
+}
+
+inline Disk_BTree::Result Disk_BTree::search_node(const Element &ele) const {
+
+    if(empty())
+        return nullptr;
+
+    int32_t key = ele.get();
+    const Disk_Leaf *node = leaf(find_leaf(key));
+    size_t pos = detail::bplus_count_less(node->keys, node->header.num_keys, key);
+
+    if(pos < node->header.num_keys && node->keys[pos] == key)
+        return ele;
+    return nullptr;
+}
+
+inline Disk_BTree::Result Disk_BTree::lower_bound(const Element &ele) const {
+
+    // the first element >= ele
+    Result result = nullptr;
+    for_each_in_range(ele, MAX_ELEMENT, [&](const Element &found) {
+        result = found;
+        return false;
+    });
+    return result;
+}
+
+inline void Disk_BTree::insert_node(const Element &ele) {
+
+    if(std::holds_alternative<Element>(search_node(ele))) {
+        throw std::runtime_error("The element has been in the Disk_BTree");
+    }
+
+    // path copies, splits and a new root never need more pages than this
+    ensure_capacity(2 * num_levels + 2);
+    dirty = true;
+    num_keys ++;
+
+    int32_t key = ele.get();
+    if(root == NIL) {
+        root = allocate(LEAF);
+        leaf(root)->keys[0] = key;
+        leaf(root)->header.num_keys = 1;
+        num_levels = 1;
+        return;
+    }
+
+    uint64_t path[MAX_HEIGHT];
+    size_t index[MAX_HEIGHT], depth = 0;
+
+    Disk_Leaf *node = leaf(cow_path(key, path, index, depth));
+    size_t n = node->header.num_keys, pos = detail::bplus_count_less(node->keys, n, key);
+
+    if(n < Disk_Leaf::MAX_KEYS) {
+        std::memmove(node->keys + pos + 1, node->keys + pos, (n - pos) * sizeof(int32_t));
+        node->keys[pos] = key;
+        node->header.num_keys ++;
+        return;
+    }
+
+    // split a full leaf: the upper half moves to a new right sibling
+    uint64_t right_id = allocate(LEAF);
+    Disk_Leaf *right = leaf(right_id);
+    int32_t temp[Disk_Leaf::MAX_KEYS + 1];
+
+    std::memcpy(temp, node->keys, pos * sizeof(int32_t));
+    temp[pos] = key;
+    std::memcpy(temp + pos + 1, node->keys + pos, (n - pos) * sizeof(int32_t));
+
+    size_t total = n + 1, left_count = total / 2;
+    std::memcpy(node->keys, temp, left_count * sizeof(int32_t));
+    std::memcpy(right->keys, temp + left_count, (total - left_count) * sizeof(int32_t));
+    node->header.num_keys  = static_cast<uint32_t>(left_count);
+    right->header.num_keys = static_cast<uint32_t>(total - left_count);
+
+    insert_parent(path, index, depth, right->keys[0], right_id);
+}
+
+inline void Disk_BTree::delete_node(const Element ele) {
+
+    if(!std::holds_alternative<Element>(search_node(ele)))
+        return; // Not found
+
+    // path copies and the sibling copies of the rebalancing
+    ensure_capacity(2 * num_levels + 1);
+    dirty = true;
+    num_keys --;
+
+    uint64_t path[MAX_HEIGHT];
+    size_t index[MAX_HEIGHT], depth = 0;
+
+    int32_t key = ele.get();
+    uint64_t id = cow_path(key, path, index, depth);
+    Disk_Leaf *node = leaf(id);
+    size_t n = node->header.num_keys, pos = detail::bplus_count_less(node->keys, n, key);
+
+    std::memmove(node->keys + pos, node->keys + pos + 1, (n - pos - 1) * sizeof(int32_t));
+    node->header.num_keys --;
+
+    fix_leaf(id, path, index, depth);
+}
+
+inline void Disk_BTree::modify_node(const Element &ele, const Element &new_ele) {
+
+    delete_node(ele);
+    insert_node(new_ele);
+}
+
+template <typename Iter>
+void Disk_BTree::bulk_load(Iter first, Iter last) {
+
+    if(!empty()) {
+        throw std::runtime_error("Bulk loading needs an empty Disk_BTree");
+    }
+
+    std::vector<int32_t> keys;
+    for(; first != last; ++first)
+        keys.push_back(Element(*first).get());
+    if(!std::is_sorted(keys.begin(), keys.end()))
+        std::sort(keys.begin(), keys.end());
+
+    if(std::adjacent_find(keys.begin(), keys.end()) != keys.end()) {
+        throw std::runtime_error("The element has been in the Disk_BTree");
+    }
+
+    if(keys.empty())
+        return;
+
+    // every level is allocated in one run, so the leaves sit in key order in the file
+    size_t n = keys.size(), num_leaves = (n + Disk_Leaf::MAX_KEYS - 1) / Disk_Leaf::MAX_KEYS;
+    size_t total_pages = num_leaves;
+    for(size_t count = num_leaves; count > 1; ) {
+        count = (count + Disk_Inner::MAX_KEYS) / (Disk_Inner::MAX_KEYS + 1);
+        total_pages += count;
+    }
+    ensure_capacity(total_pages);
+    dirty = true;
+
+    std::vector<uint64_t> level;
+    std::vector<int32_t> low_keys;  // the smallest key under each page of the level
+
+    size_t pos = 0;
+    for(size_t i = 0; i < num_leaves; ++i) {
+        size_t count = n / num_leaves + ((i < n % num_leaves) ? (1) : (0));
+        uint64_t id = allocate(LEAF);
+
+        std::memcpy(leaf(id)->keys, keys.data() + pos, count * sizeof(int32_t));
+        leaf(id)->header.num_keys = static_cast<uint32_t>(count);
+        level.push_back(id);
+        low_keys.push_back(keys[pos]);
+        pos += count;
+    }
+    num_levels = 1;
+
+    while(level.size() > 1) {
+        size_t num_children = level.size(), num_groups = (num_children + Disk_Inner::MAX_KEYS) / (Disk_Inner::MAX_KEYS + 1);
+        std::vector<uint64_t> upper;
+        std::vector<int32_t> upper_keys;
+
+        pos = 0;
+        for(size_t i = 0; i < num_groups; ++i) {
+            size_t count = num_children / num_groups + ((i < num_children % num_groups) ? (1) : (0));
+            uint64_t id = allocate(INNER);
+            Disk_Inner *node = inner(id);
+
+            upper_keys.push_back(low_keys[pos]);
+            for(size_t j = 0; j < count; ++j, ++pos) {
+                node->children[j] = level[pos];
+                if(j > 0) node->keys[j - 1] = low_keys[pos];
+            }
+            node->header.num_keys = static_cast<uint32_t>(count - 1);
+            upper.push_back(id);
+        }
+
+        level.swap(upper);
+        low_keys.swap(upper_keys);
+        num_levels ++;
+    }
+
+    root = level[0];
+    num_keys = n;
+    commit();
+}
+
+template <typename Func>
+void Disk_BTree::for_each_in_range(const Element &lo, const Element &hi, Func fn) const {
+
+    // a cursor of (page, child) pairs: leaves are visited left to right without leaf links,
+    // which copy-on-write could not keep up to date. fn may return false to stop early.
+    if(empty())
+        return;
+
+    int32_t low = lo.get(), high = hi.get();
+    uint64_t path[MAX_HEIGHT];
+    size_t index[MAX_HEIGHT], depth = 0;
+
+    uint64_t id = root;
+    while(header(id)->type == INNER) {
+        const Disk_Inner *node = inner(id);
+        size_t idx = detail::bplus_count_less_equal(node->keys, node->header.num_keys, low);
+        path[depth] = id;
+        index[depth ++] = idx;
+        id = node->children[idx];
+    }
+
+    size_t pos = detail::bplus_count_less(leaf(id)->keys, leaf(id)->header.num_keys, low);
+    while(true) {
+        const Disk_Leaf *node = leaf(id);
+        for(; pos < node->header.num_keys; ++pos) {
+            if(high < node->keys[pos])
+                return;
+            if constexpr (std::is_same_v<std::invoke_result_t<Func, const Element&>, bool>) {
+                if(!fn(Element(node->keys[pos])))
+                    return;
+            }
+            else {
+                fn(Element(node->keys[pos]));
+            }
+        }
+
+        // climb to the first ancestor with a child left to visit, then take its leftmost leaf
+        while(depth > 0 && index[depth - 1] == inner(path[depth - 1])->header.num_keys)
+            depth --;
+        if(depth == 0)
+            return;
+
+        id = inner(path[depth - 1])->children[++ index[depth - 1]];
+        while(header(id)->type == INNER) {
+            path[depth] = id;
+            index[depth ++] = 0;
+            id = inner(id)->children[0];
+        }
+        pos = 0;
+    }
+}
+
+inline void Disk_BTree::commit() {
+
+    // shadow paging: new pages are flushed first, then the other meta slot is switched over
+    if(!dirty)
+        return;
+
+    // the old free list is still reachable from the last commit
+    pending.insert(pending.end(), list_pages.begin(), list_pages.end());
+    list_pages.clear();
+
+    size_t count = (reusable.size() + pending.size() + Disk_Free_List::MAX_IDS - 1) / Disk_Free_List::MAX_IDS;
+    ensure_capacity(count);
+    for(size_t i = 0; i < count; ++i)
+        list_pages.push_back(allocate(FREE_LIST));
+
+    // after this commit the pages dropped in this transaction are free in both slots
+    reusable.insert(reusable.end(), pending.begin(), pending.end());
+    pending.clear();
+
+    size_t pos = 0;
+    for(size_t i = 0; i < list_pages.size(); ++i) {
+        Disk_Free_List *list = reinterpret_cast<Disk_Free_List*>(header(list_pages[i]));
+        size_t take = std::min(Disk_Free_List::MAX_IDS, reusable.size() - pos);
+
+        std::copy(reusable.begin() + pos, reusable.begin() + pos + take, list->ids);
+        list->header.num_keys = static_cast<uint32_t>(take);
+        list->next = (i + 1 < list_pages.size()) ? (list_pages[i + 1]) : (NIL);
+        pos += take;
+    }
+
+    if(::msync(base, num_pages * DISK_PAGE_SIZE, MS_SYNC) != 0) {
+        throw std::runtime_error("Cannot flush the Disk_BTree pages");
+    }
+
+    write_meta();
+    dirty = false;
+}
+
+inline void Disk_BTree::inorder(std::ostream &os) const {
+
+    for_each_in_range(MIN_ELEMENT, MAX_ELEMENT, [&](const Element &ele) {
+        os << ele << ", ";
+    });
+    os << std::endl;
+}
+
+inline void Disk_BTree::show(std::ostream &os) const {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Height: " << std::setw(4) << height() << ", ";
+    os << "Pages: " << num_pages << " / " << capacity << ", ";
+    os << "Free: " << reusable.size() + pending.size() << ", ";
+    os << "Transaction: " << committed_tx << std::endl;
+}
+
+inline bool Disk_BTree::empty() const {
+    return (size() == 0);
+}
+
+inline size_t Disk_BTree::size() const {
+    return num_keys;
+}
+
+inline size_t Disk_BTree::height() const {
+    return num_levels;
+}
+
+inline Disk_Page_Header* Disk_BTree::header(uint64_t id) const {
+    return reinterpret_cast<Disk_Page_Header*>(base + id * DISK_PAGE_SIZE);
+}
+
+inline Disk_Leaf* Disk_BTree::leaf(uint64_t id) const {
+    return reinterpret_cast<Disk_Leaf*>(base + id * DISK_PAGE_SIZE);
+}
+
+inline Disk_Inner* Disk_BTree::inner(uint64_t id) const {
+    return reinterpret_cast<Disk_Inner*>(base + id * DISK_PAGE_SIZE);
+}
+
+inline Disk_Meta* Disk_BTree::meta(uint64_t slot) const {
+    return reinterpret_cast<Disk_Meta*>(base + slot * DISK_PAGE_SIZE);
+}
+
+inline uint64_t Disk_BTree::checksum(const Disk_Meta &m) {
+
+    // FNV-1a over every field before the checksum
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(&m);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(size_t i = 0; i < offsetof(Disk_Meta, checksum); ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+inline void Disk_BTree::map_file(size_t pages) {
+
+    // the new mapping is made before the old one goes, so a failure leaves base and capacity as they were
+    struct stat st;
+    if(::fstat(fd, &st) != 0) {
+        throw std::runtime_error("Cannot stat the Disk_BTree file");
+    }
+
+    if(static_cast<size_t>(st.st_size) < pages * DISK_PAGE_SIZE && ::ftruncate(fd, pages * DISK_PAGE_SIZE) != 0) {
+        throw std::runtime_error("Cannot grow the Disk_BTree file");
+    }
+
+    void *addr = ::mmap(nullptr, pages * DISK_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(addr == MAP_FAILED) {
+        throw std::runtime_error("Cannot map the Disk_BTree file");
+    }
+
+    if(base != nullptr)
+        ::munmap(base, capacity * DISK_PAGE_SIZE);
+    base = static_cast<char*>(addr);
+    capacity = pages;
+}
+
+inline void Disk_BTree::ensure_capacity(size_t extra) {
+
+    // remap before an operation starts, so page pointers stay valid within it
+    if(num_pages + extra <= capacity)
+        return;
+
+    size_t pages = capacity;
+    while(pages < num_pages + extra)
+        pages *= 2;
+    map_file(pages);
+}
+
+inline uint64_t Disk_BTree::allocate(uint32_t type) {
+
+    uint64_t id;
+    if(!reusable.empty()) {
+        id = reusable.back();
+        reusable.pop_back();
+    }
+    else {
+        assert(num_pages < capacity);
+        id = num_pages ++;
+    }
+
+    Disk_Page_Header *page = header(id);
+    page->txid = curr_tx;
+    page->type = type;
+    page->num_keys = 0;
+    return id;
+}
+
+inline uint64_t Disk_BTree::cow(uint64_t id) {
+
+    // a page of an earlier transaction is never overwritten, it is copied and dropped
+    if(header(id)->txid == curr_tx)
+        return id;
+
+    uint64_t copy = allocate(header(id)->type);
+    std::memcpy(header(copy), header(id), DISK_PAGE_SIZE);
+    header(copy)->txid = curr_tx;
+    pending.push_back(id);
+    return copy;
+}
+
+inline void Disk_BTree::release(uint64_t id) {
+
+    // a page written by this transaction is unreachable from the last commit
+    if(header(id)->txid == curr_tx) reusable.push_back(id);
+    else                             pending.push_back(id);
+}
+
+inline uint64_t Disk_BTree::find_leaf(int32_t key) const {
+
+    uint64_t id = root;
+    while(header(id)->type == INNER) {
+        const Disk_Inner *node = inner(id);
+        id = node->children[detail::bplus_count_less_equal(node->keys, node->header.num_keys, key)];
+    }
+    return id;
+}
+
+inline uint64_t Disk_BTree::cow_path(int32_t key, uint64_t* path, size_t* index, size_t &depth) {
+
+    // copy every page from the root to the leaf and relink each copy into its copied parent
+    root = cow(root);
+    uint64_t id = root;
+
+    while(header(id)->type == INNER) {
+        size_t idx = detail::bplus_count_less_equal(inner(id)->keys, inner(id)->header.num_keys, key);
+        uint64_t child = cow(inner(id)->children[idx]);
+
+        inner(id)->children[idx] = child;
+        path[depth] = id;
+        index[depth ++] = idx;
+        id = child;
+    }
+    return id;
+}
+
+inline void Disk_BTree::insert_parent(uint64_t* path, size_t* index, size_t depth, int32_t separator, uint64_t right) {
+
+    while(depth > 0) {
+        Disk_Inner *parent = inner(path[depth - 1]);
+        size_t pos = index[depth - 1], n = parent->header.num_keys;
+        depth --;
+
+        if(n < Disk_Inner::MAX_KEYS) {
+            std::memmove(parent->keys + pos + 1, parent->keys + pos, (n - pos) * sizeof(int32_t));
+            std::memmove(parent->children + pos + 2, parent->children + pos + 1, (n - pos) * sizeof(uint64_t));
+            parent->keys[pos] = separator;
+            parent->children[pos + 1] = right;
+            parent->header.num_keys ++;
+            return;
+        }
+
+        // split a full inner page, the middle key moves up
+        int32_t temp_keys[Disk_Inner::MAX_KEYS + 1];
+        uint64_t temp_children[Disk_Inner::MAX_KEYS + 2];
+
+        std::memcpy(temp_keys, parent->keys, pos * sizeof(int32_t));
+        temp_keys[pos] = separator;
+        std::memcpy(temp_keys + pos + 1, parent->keys + pos, (n - pos) * sizeof(int32_t));
+        std::memcpy(temp_children, parent->children, (pos + 1) * sizeof(uint64_t));
+        temp_children[pos + 1] = right;
+        std::memcpy(temp_children + pos + 2, parent->children + pos + 1, (n - pos) * sizeof(uint64_t));
+
+        size_t total = n + 1, mid = total / 2;
+        uint64_t sibling_id = allocate(INNER);
+        Disk_Inner *sibling = inner(sibling_id);
+
+        std::memcpy(parent->keys, temp_keys, mid * sizeof(int32_t));
+        std::memcpy(parent->children, temp_children, (mid + 1) * sizeof(uint64_t));
+        parent->header.num_keys = static_cast<uint32_t>(mid);
+
+        std::memcpy(sibling->keys, temp_keys + mid + 1, (total - mid - 1) * sizeof(int32_t));
+        std::memcpy(sibling->children, temp_children + mid + 1, (total - mid) * sizeof(uint64_t));
+        sibling->header.num_keys = static_cast<uint32_t>(total - mid - 1);
+
+        separator = temp_keys[mid];
+        right = sibling_id;
+    }
+
+    // the root has been split
+    uint64_t new_root = allocate(INNER);
+    inner(new_root)->keys[0] = separator;
+    inner(new_root)->children[0] = root;
+    inner(new_root)->children[1] = right;
+    inner(new_root)->header.num_keys = 1;
+    root = new_root;
+    num_levels ++;
+}
+
+inline void Disk_BTree::fix_leaf(uint64_t id, uint64_t* path, size_t* index, size_t depth) {
+
+    Disk_Leaf *node = leaf(id);
+    if(depth == 0) {
+        if(node->header.num_keys == 0) {
+            release(id);
+            root = NIL;
+            num_levels = 0;
+        }
+        return;
+    }
+
+    if(node->header.num_keys >= Disk_Leaf::MIN_KEYS)
+        return;
+
+    Disk_Inner *parent = inner(path[depth - 1]);
+    size_t idx = index[depth - 1];
+
+    if(idx > 0 && leaf(parent->children[idx - 1])->header.num_keys > Disk_Leaf::MIN_KEYS) {
+        // borrow the largest key of the left sibling
+        Disk_Leaf *left = leaf(parent->children[idx - 1] = cow(parent->children[idx - 1]));
+        std::memmove(node->keys + 1, node->keys, node->header.num_keys * sizeof(int32_t));
+        node->keys[0] = left->keys[-- left->header.num_keys];
+        node->header.num_keys ++;
+        parent->keys[idx - 1] = node->keys[0];
+        return;
+    }
+
+    if(idx < parent->header.num_keys && leaf(parent->children[idx + 1])->header.num_keys > Disk_Leaf::MIN_KEYS) {
+        // borrow the smallest key of the right sibling
+        Disk_Leaf *right = leaf(parent->children[idx + 1] = cow(parent->children[idx + 1]));
+        node->keys[node->header.num_keys ++] = right->keys[0];
+        std::memmove(right->keys, right->keys + 1, (-- right->header.num_keys) * sizeof(int32_t));
+        parent->keys[idx] = right->keys[0];
+        return;
+    }
+
+    // merge the right page of the pair into the left one
+    uint64_t source = parent->children[idx + 1];
+    if(idx > 0) {
+        source = id;
+        idx --;
+        id = parent->children[idx] = cow(parent->children[idx]);
+    }
+
+    Disk_Leaf *left = leaf(id), *right = leaf(source);
+    std::memcpy(left->keys + left->header.num_keys, right->keys, right->header.num_keys * sizeof(int32_t));
+    left->header.num_keys += right->header.num_keys;
+    release(source);
+
+    size_t n = parent->header.num_keys;
+    std::memmove(parent->keys + idx, parent->keys + idx + 1, (n - idx - 1) * sizeof(int32_t));
+    std::memmove(parent->children + idx + 1, parent->children + idx + 2, (n - idx - 1) * sizeof(uint64_t));
+    parent->header.num_keys --;
+
+    fix_inner(path[depth - 1], path, index, depth - 1);
+}
+
+inline void Disk_BTree::fix_inner(uint64_t id, uint64_t* path, size_t* index, size_t depth) {
+
+    while(true) {
+        Disk_Inner *node = inner(id);
+        if(depth == 0) {
+            if(node->header.num_keys == 0) {
+                root = node->children[0];
+                release(id);
+                num_levels --;
+            }
+            return;
+        }
+
+        if(node->header.num_keys >= Disk_Inner::MIN_KEYS)
+            return;
+
+        Disk_Inner *parent = inner(path[depth - 1]);
+        size_t idx = index[depth - 1], n = node->header.num_keys;
+
+        if(idx > 0 && inner(parent->children[idx - 1])->header.num_keys > Disk_Inner::MIN_KEYS) {
+            // rotate through the parent: the separator comes down, the left's last key goes up
+            Disk_Inner *left = inner(parent->children[idx - 1] = cow(parent->children[idx - 1]));
+            size_t m = left->header.num_keys;
+
+            std::memmove(node->keys + 1, node->keys, n * sizeof(int32_t));
+            std::memmove(node->children + 1, node->children, (n + 1) * sizeof(uint64_t));
+            node->keys[0] = parent->keys[idx - 1];
+            node->children[0] = left->children[m];
+            parent->keys[idx - 1] = left->keys[m - 1];
+            node->header.num_keys ++;
+            left->header.num_keys --;
+            return;
+        }
+
+        if(idx < parent->header.num_keys && inner(parent->children[idx + 1])->header.num_keys > Disk_Inner::MIN_KEYS) {
+            Disk_Inner *right = inner(parent->children[idx + 1] = cow(parent->children[idx + 1]));
+            size_t m = right->header.num_keys;
+
+            node->keys[n] = parent->keys[idx];
+            node->children[n + 1] = right->children[0];
+            parent->keys[idx] = right->keys[0];
+            node->header.num_keys ++;
+
+            std::memmove(right->keys, right->keys + 1, (m - 1) * sizeof(int32_t));
+            std::memmove(right->children, right->children + 1, m * sizeof(uint64_t));
+            right->header.num_keys --;
+            return;
+        }
+
+        // merge the right page of the pair into the left one, the separator comes down between them
+        uint64_t source = parent->children[idx + 1];
+        if(idx > 0) {
+            source = id;
+            idx --;
+            id = parent->children[idx] = cow(parent->children[idx]);
+        }
+
+        Disk_Inner *left = inner(id), *right = inner(source);
+        size_t base_keys = left->header.num_keys, m = right->header.num_keys;
+
+        left->keys[base_keys] = parent->keys[idx];
+        std::memcpy(left->keys + base_keys + 1, right->keys, m * sizeof(int32_t));
+        std::memcpy(left->children + base_keys + 1, right->children, (m + 1) * sizeof(uint64_t));
+        left->header.num_keys += m + 1;
+        release(source);
+
+        size_t p = parent->header.num_keys;
+        std::memmove(parent->keys + idx, parent->keys + idx + 1, (p - idx - 1) * sizeof(int32_t));
+        std::memmove(parent->children + idx + 1, parent->children + idx + 2, (p - idx - 1) * sizeof(uint64_t));
+        parent->header.num_keys --;
+
+        id = path[depth - 1];
+        depth --;
+    }
+}
+
+inline void Disk_BTree::load_free_list(uint64_t head) {
+
+    for(uint64_t id = head; id != NIL; ) {
+        const Disk_Free_List *list = reinterpret_cast<const Disk_Free_List*>(header(id));
+        reusable.insert(reusable.end(), list->ids, list->ids + list->header.num_keys);
+        list_pages.push_back(id);
+        id = list->next;
+    }
+}
+
+inline void Disk_BTree::write_meta() {
+
+    // the slot of the older commit is overwritten, the newer one stays intact until this is on disk
+    Disk_Meta m{};
+    m.magic = MAGIC;
+    m.page_size = DISK_PAGE_SIZE;
+    m.txid = curr_tx;
+    m.root = root;
+    m.num_pages = num_pages;
+    m.num_keys = num_keys;
+    m.height = num_levels;
+    m.free_head = (list_pages.empty()) ? (NIL) : (list_pages[0]);
+    m.checksum = checksum(m);
+
+    uint64_t slot = curr_tx % 2;
+    std::memcpy(meta(slot), &m, sizeof(Disk_Meta));
+    if(::msync(base + slot * DISK_PAGE_SIZE, DISK_PAGE_SIZE, MS_SYNC) != 0) {
+        throw std::runtime_error("Cannot flush the Disk_BTree meta page");
+    }
+
+    committed_tx = curr_tx ++;
+}
+
+}
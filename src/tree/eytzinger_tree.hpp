@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <fstream>
+#include <variant>
+#include <vector>
+#include <algorithm>
+#include <bit>
+
+/* Declaration */
+/* Read-only search tree stored in Eytzinger (BFS) order */
+namespace ds_imp {
+
+template <typename T>
+class Eytzinger_Tree {
+
+    using Result = std::variant<std::nullptr_t, T>;
+
+    public:
+        Eytzinger_Tree();
+        template <typename Iter>
+        Eytzinger_Tree(Iter first, Iter last);
+        ~Eytzinger_Tree();
+
+        bool contains(const T &ele) const;
+        Result lower_bound(const T &ele) const;
+        size_t rank(const T &ele) const;
+        void traversal(std::ostream &os) const;
+        inline bool empty() const;
+        inline size_t size() const;
+
+        // children of k are 2k and 2k + 1, so the nodes 4 levels down from k fill one cache line
+        static constexpr size_t PREFETCH_STRIDE = std::max<size_t>(1, 64 / sizeof(T));
+
+    private:
+        std::vector<T> data;  // data[1 .. num_nodes], data[0] is unused
+        size_t num_nodes;
+        size_t last_level;    // the depth of the deepest level, the root is at depth 0
+
+        template <typename Iter>
+        void fill(Iter &it, size_t k);
+        inline void prefetch(size_t k) const;
+        inline size_t search(const T &ele) const;
+        inline size_t subtree_size(size_t k) const;
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+template <typename T>
+Eytzinger_Tree<T>::Eytzinger_Tree()
+    : data(1),
+      num_nodes(0),
+      last_level(0) {}
+
+template <typename T>
+template <typename Iter>
+Eytzinger_Tree<T>::Eytzinger_Tree(Iter first, Iter last) : Eytzinger_Tree() {
+
+    std::vector<T> elements(first, last);
+    if(!std::is_sorted(elements.begin(), elements.end()))
+        std::sort(elements.begin(), elements.end());
+
+    num_nodes = elements.size();
+    last_level = (num_nodes == 0) ? (0) : (std::bit_width(num_nodes) - 1);
+    data.resize(num_nodes + 1);
+
+    auto it = elements.begin();
+    fill(it, 1);
+}
+
+template <typename T>
+Eytzinger_Tree<T>::~Eytzinger_Tree() = default;
+
+template <typename T>
+bool Eytzinger_Tree<T>::contains(const T &ele) const {
+
+    size_t k = search(ele);
+    return k != 0 && data[k] == ele;
+}
+
+template <typename T>
+Eytzinger_Tree<T>::Result Eytzinger_Tree<T>::lower_bound(const T &ele) const {
+
+    // the first element >= ele
+    size_t k = search(ele);
+    if(k == 0)
+        return nullptr;
+    return data[k];
+}
+
+template <typename T>
+size_t Eytzinger_Tree<T>::rank(const T &ele) const {
+
+    // the number of elements < ele: every right turn passes a node and its left subtree
+    size_t k = 1, count = 0;
+    while(k <= num_nodes) {
+        prefetch(k);
+        size_t go_right = (data[k] < ele);
+        count += go_right * (subtree_size(2 * k) + 1);
+        k = 2 * k + go_right;
+    }
+    return count;
+}
+
+template <typename T>
+void Eytzinger_Tree<T>::traversal(std::ostream &os) const {
+
+    for(size_t k = 1; k <= num_nodes; ++k) {
+        os << data[k] << ", ";
+    }
+    os << std::endl;
+}
+
+template <typename T>
+inline bool Eytzinger_Tree<T>::empty() const {
+    return (size() == 0);
+}
+
+template <typename T>
+inline size_t Eytzinger_Tree<T>::size() const {
+    return num_nodes;
+}
+
+template <typename T>
+template <typename Iter>
+void Eytzinger_Tree<T>::fill(Iter &it, size_t k) {
+
+    // an in-order walk of the implicit tree takes the sorted elements one by one
+    if(k > num_nodes)
+        return;
+
+    fill(it, 2 * k);
+    data[k] = std::move(*it);
+    ++it;
+    fill(it, 2 * k + 1);
+}
+
+template <typename T>
+inline void Eytzinger_Tree<T>::prefetch(size_t k) const {
+#if defined(__GNUC__)
+    __builtin_prefetch(data.data() + std::min(k * PREFETCH_STRIDE, num_nodes));
+#endif
+}
+
+template <typename T>
+inline size_t Eytzinger_Tree<T>::search(const T &ele) const {
+
+    // branchless descent, then undo the right turns taken after the last left turn
+    size_t k = 1;
+    while(k <= num_nodes) {
+        prefetch(k);
+        k = 2 * k + (data[k] < ele);
+    }
+    k >>= std::countr_one(k) + 1;
+    return k;  // 0 when every element < ele
+}
+
+template <typename T>
+inline size_t Eytzinger_Tree<T>::subtree_size(size_t k) const {
+
+    if(k > num_nodes)
+        return 0;
+
+    // the levels above last_level are full, the last level is cut at num_nodes
+    size_t depth = std::bit_width(k) - 1, span = static_cast<size_t>(1) << (last_level - depth);
+    size_t first = k * span, last = std::min(first + span - 1, num_nodes);
+    return (span - 1) + ((last >= first) ? (last - first + 1) : (0));
+}
+
+}
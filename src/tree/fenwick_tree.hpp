@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <span>
+#include <vector>
+#include <bit>
+#include <algorithm>
+
+/* Declaration */
+namespace ds_imp {
+
+template <typename T>
+class Fenwick_Tree {
+
+    public:
+        Fenwick_Tree(size_t n = 0);
+        template <typename Iter>
+        Fenwick_Tree(Iter first, Iter last);
+        ~Fenwick_Tree();
+
+        void add(size_t i, const T &delta);
+        T prefix_sum(size_t i) const;
+        std::vector<T> prefix_sums(std::span<const size_t> indices) const;
+        T range_sum(size_t l, size_t r) const;
+        size_t lower_bound(T value) const;
+        void show(std::ostream &os) const;
+        inline bool empty() const;
+        inline size_t size() const;
+
+    private:
+        size_t num_slots;
+        std::vector<T> tree;  // tree[i] sums the slots (i - lowbit(i), i], tree[0] is unused
+};
+
+template <typename T>
+class Fenwick_Tree_2D {
+
+    public:
+        Fenwick_Tree_2D(size_t rows = 0, size_t cols = 0);
+        ~Fenwick_Tree_2D();
+
+        void add(size_t r, size_t c, const T &delta);
+        T prefix_sum(size_t r, size_t c) const;
+        T range_sum(size_t r1, size_t c1, size_t r2, size_t c2) const;
+        inline size_t rows() const;
+        inline size_t cols() const;
+
+    private:
+        size_t num_rows;
+        size_t num_cols;
+        std::vector<T> tree;  // (num_rows + 1) x (num_cols + 1), row-major
+
+        inline T& at(size_t r, size_t c);
+        inline const T& at(size_t r, size_t c) const;
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+/* Fenwick_Tree */
+template <typename T>
+Fenwick_Tree<T>::Fenwick_Tree(size_t n)
+    : num_slots(n),
+      tree(n + 1, T(0)) {}
+
+template <typename T>
+template <typename Iter>
+Fenwick_Tree<T>::Fenwick_Tree(Iter first, Iter last) : Fenwick_Tree(static_cast<size_t>(std::distance(first, last))) {
+
+    // O(n): each node passes its finished sum to its parent once
+    for(size_t i = 1; first != last; ++first, ++i)
+        tree[i] = *first;
+
+    for(size_t i = 1; i <= num_slots; ++i) {
+        size_t parent = i + (i & (~i + 1));
+        if(parent <= num_slots)
+            tree[parent] = tree[parent] + tree[i];
+    }
+}
+
+template <typename T>
+Fenwick_Tree<T>::~Fenwick_Tree() = default;
+
+template <typename T>
+void Fenwick_Tree<T>::add(size_t i, const T &delta) {
+
+    if(i >= num_slots) {
+        throw std::out_of_range("The index is out of the Fenwick_Tree");
+    }
+
+    for(++i; i <= num_slots; i += (i & (~i + 1)))
+        tree[i] = tree[i] + delta;
+}
+
+template <typename T>
+T Fenwick_Tree<T>::prefix_sum(size_t i) const {
+
+    // the sum of the slots [0, i)
+    if(i > num_slots) {
+        throw std::out_of_range("The index is out of the Fenwick_Tree");
+    }
+
+    T sum = T(0);
+    for(; i > 0; i &= i - 1)
+        sum = sum + tree[i];
+    return sum;
+}
+
+template <typename T>
+std::vector<T> Fenwick_Tree<T>::prefix_sums(std::span<const size_t> indices) const {
+
+    // no query depends on another, so the CPU overlaps their cache misses on its own;
+    // validating once up front keeps the throw out of the summing loop
+    for(size_t i : indices) {
+        if(i > num_slots) {
+            throw std::out_of_range("The index is out of the Fenwick_Tree");
+        }
+    }
+
+    std::vector<T> sums(indices.size(), T(0));
+    for(size_t k = 0; k < indices.size(); ++k) {
+        T sum = T(0);
+        for(size_t i = indices[k]; i > 0; i &= i - 1)
+            sum = sum + tree[i];
+        sums[k] = sum;
+    }
+    return sums;
+}
+
+template <typename T>
+T Fenwick_Tree<T>::range_sum(size_t l, size_t r) const {
+
+    // the sum of the slots [l, r)
+    if(l > r) {
+        throw std::out_of_range("The range is out of the Fenwick_Tree");
+    }
+    return prefix_sum(r) - prefix_sum(l);
+}
+
+template <typename T>
+size_t Fenwick_Tree<T>::lower_bound(T value) const {
+
+    // the smallest i with prefix_sum(i + 1) >= value, size() if none; slots must be non-negative.
+    // Binary lifting: try each power of two from the top, keeping the step when the sum stays below value
+    size_t pos = 0;
+    for(size_t step = std::bit_floor(std::max<size_t>(num_slots, 1)); step > 0; step >>= 1) {
+        if(pos + step <= num_slots && tree[pos + step] < value) {
+            pos += step;
+            value = value - tree[pos];
+        }
+    }
+    return pos;
+}
+
+template <typename T>
+void Fenwick_Tree<T>::show(std::ostream &os) const {
+
+    os << "Size: " << std::setw(4) << size() << std::endl;
+    for(size_t i = 1; i <= num_slots; ++i)
+        os << tree[i] << ", ";
+    os << std::endl;
+}
+
+template <typename T>
+inline bool Fenwick_Tree<T>::empty() const {
+    return (size() == 0);
+}
+
+template <typename T>
+inline size_t Fenwick_Tree<T>::size() const {
+    return num_slots;
+}
+
+/* Fenwick_Tree_2D */
+template <typename T>
+Fenwick_Tree_2D<T>::Fenwick_Tree_2D(size_t rows, size_t cols)
+    : num_rows(rows),
+      num_cols(cols),
+      tree((rows + 1) * (cols + 1), T(0)) {}
+
+template <typename T>
+Fenwick_Tree_2D<T>::~Fenwick_Tree_2D() = default;
+
+template <typename T>
+void Fenwick_Tree_2D<T>::add(size_t r, size_t c, const T &delta) {
+
+    if(r >= num_rows || c >= num_cols) {
+        throw std::out_of_range("The index is out of the Fenwick_Tree_2D");
+    }
+
+    for(size_t i = r + 1; i <= num_rows; i += (i & (~i + 1))) {
+        for(size_t j = c + 1; j <= num_cols; j += (j & (~j + 1)))
+            at(i, j) = at(i, j) + delta;
+    }
+}
+
+template <typename T>
+T Fenwick_Tree_2D<T>::prefix_sum(size_t r, size_t c) const {
+
+    // the sum of the cells [0, r) x [0, c)
+    if(r > num_rows || c > num_cols) {
+        throw std::out_of_range("The index is out of the Fenwick_Tree_2D");
+    }
+
+    T sum = T(0);
+    for(size_t i = r; i > 0; i &= i - 1) {
+        for(size_t j = c; j > 0; j &= j - 1)
+            sum = sum + at(i, j);
+    }
+    return sum;
+}
+
+template <typename T>
+T Fenwick_Tree_2D<T>::range_sum(size_t r1, size_t c1, size_t r2, size_t c2) const {
+
+    // the sum of the cells [r1, r2) x [c1, c2)
+    if(r1 > r2 || c1 > c2) {
+        throw std::out_of_range("The range is out of the Fenwick_Tree_2D");
+    }
+    return prefix_sum(r2, c2) - prefix_sum(r1, c2) - prefix_sum(r2, c1) + prefix_sum(r1, c1);
+}
+
+template <typename T>
+inline size_t Fenwick_Tree_2D<T>::rows() const {
+    return num_rows;
+}
+
+template <typename T>
+inline size_t Fenwick_Tree_2D<T>::cols() const {
+    return num_cols;
+}
+
+template <typename T>
+inline T& Fenwick_Tree_2D<T>::at(size_t r, size_t c) {
+    return tree[r * (num_cols + 1) + c];
+}
+
+template <typename T>
+inline const T& Fenwick_Tree_2D<T>::at(size_t r, size_t c) const {
+    return tree[r * (num_cols + 1) + c];
+}
+
+}
@@ -41,6 +41,8 @@ struct LeftistNode {
     /* Destructor */
     ~LeftistNode();
 
+    static void release(LeftistNode<T>* node);
+
     friend LeftistNode<T>* meld_root<T>(LeftistNode<T> *root_x, LeftistNode<T> *root_y);
 };
 
@@ -93,8 +95,30 @@ LeftistNode<T>::LeftistNode(
 template <typename T>
 LeftistNode<T>::~LeftistNode() {
 
-    if( left != nullptr) delete left;
-    if(right != nullptr) delete right;
+    // iterative destruction
+    release(left);
+    release(right);
+}
+
+template <typename T>
+void LeftistNode<T>::release(LeftistNode<T>* node) {
+
+    // rotate left children up until the subtree becomes a right chain, then free the chain
+    LeftistNode<T> *temp = nullptr;
+    while(node != nullptr) {
+        if(node->left != nullptr) {
+            temp = node->left;
+            node->left = temp->right;
+            temp->right = node;
+            node = temp;
+        }
+        else {
+            temp = node->right;
+            node->right = nullptr;
+            delete node;
+            node = temp;
+        }
+    }
 }
 
 template <typename T>
@@ -0,0 +1,832 @@
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <utility>
+#include <variant>
+#include <iterator>
+#include <vector>
+#include <stack>
+#include <queue>
+#include <algorithm>
+#include "eytzinger_tree.hpp"
+
+/* Declaration */
+namespace ds_imp {
+
+enum class RB_Color : uintptr_t { RED = 0, BLACK = 1 };
+
+template <typename T>
+struct RB_Node {
+    T element;
+    RB_Node<T> *left;
+    RB_Node<T> *right;
+    uintptr_t parent_color;  // the parent pointer, the color lives in its lowest bit
+
+    /* Constructor */
+    RB_Node(const T &ele = T(), RB_Node<T>* parent = nullptr, RB_Color color = RB_Color::RED);
+    RB_Node(T &&ele, RB_Node<T>* parent = nullptr, RB_Color color = RB_Color::RED);
+
+    /* Destructor */
+    ~RB_Node();
+
+    static void release(RB_Node<T>* node);
+
+    inline RB_Node<T>* parent() const;
+    inline RB_Color color() const;
+    inline bool is_red() const;
+    inline void set_parent(RB_Node<T>* node);
+    inline void set_color(RB_Color color);
+
+    void preorder(std::ostream &os);
+    void inorder(std::ostream &os);
+    void postorder(std::ostream &os);
+    void show(std::ostream &os);
+};
+
+template <typename T>
+class RB_Iterator {
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const T*;
+        using reference         = const T&;
+
+        RB_Iterator(RB_Node<T>* root = nullptr, RB_Node<T>* curr = nullptr);
+
+        reference operator*()  const;
+        pointer   operator->() const;
+        RB_Iterator<T>& operator++();
+        RB_Iterator<T>  operator++(int);
+        RB_Iterator<T>& operator--();
+        RB_Iterator<T>  operator--(int);
+        bool operator==(const RB_Iterator<T> &other) const;
+        bool operator!=(const RB_Iterator<T> &other) const;
+
+    private:
+        RB_Node<T> *root;
+        RB_Node<T> *curr;  // nullptr is end()
+};
+
+template <typename T>
+class RB_Tree {
+
+    using Pair_Result = std::pair<RB_Node<T>*, RB_Node<T>*>;
+    using Result = std::variant<std::nullptr_t, T>;
+
+    public:
+        using iterator = RB_Iterator<T>;
+
+        RB_Tree();
+        template <typename Iter>
+        RB_Tree(Iter first, Iter last);
+        ~RB_Tree();
+
+        Result get_min() const;
+        Result get_max() const;
+        Pair_Result search_node(const T &ele);
+        void insert_node(const T  &ele);
+        void insert_node(T &&ele);
+        void delete_node(const T ele);
+        void modify_node(const T &ele, const T &new_ele);
+        void modify_node(const T &ele, const T &&new_ele);
+        void preorder(std::ostream &os);
+        void inorder(std::ostream &os);
+        void postorder(std::ostream &os);
+        void show(std::ostream &os);
+        inline bool empty() const;
+        inline size_t size() const;
+        size_t height() const;
+        iterator begin() const;
+        iterator end() const;
+        iterator lower_bound(const T &ele) const;
+        iterator upper_bound(const T &ele) const;
+        std::pair<iterator, iterator> equal_range(const T &ele) const;
+        template <typename Func>
+        void for_each_in_range(const T &lo, const T &hi, Func fn) const;
+        Eytzinger_Tree<T> freeze() const;
+
+    private:
+        RB_Node<T> *root;
+        size_t num_nodes;
+
+        RB_Node<T>* build(std::vector<T> &elements, size_t lo, size_t hi, RB_Node<T>* parent, size_t depth, size_t red_depth);
+        RB_Node<T>* find_parent(const T &ele, bool &go_left) const;
+        void attach(RB_Node<T>* node, RB_Node<T>* parent, bool go_left);
+        void left_rotate(RB_Node<T>* node);
+        void right_rotate(RB_Node<T>* node);
+        void replace_child(RB_Node<T>* parent, RB_Node<T>* old_child, RB_Node<T>* new_child);
+        void insert_fixup(RB_Node<T>* node);
+        void erase(RB_Node<T>* node);
+        void erase_fixup(RB_Node<T>* node, RB_Node<T>* parent);
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+/* RB_Node */
+template <typename T>
+RB_Node<T>::RB_Node(const T &ele, RB_Node<T>* parent, RB_Color color)
+    : element(ele), left(nullptr), right(nullptr),
+      parent_color(reinterpret_cast<uintptr_t>(parent) | static_cast<uintptr_t>(color)) {}
+
+template <typename T>
+RB_Node<T>::RB_Node(T &&ele, RB_Node<T>* parent, RB_Color color)
+    : element(std::move(ele)), left(nullptr), right(nullptr),
+      parent_color(reinterpret_cast<uintptr_t>(parent) | static_cast<uintptr_t>(color)) {}
+
+template <typename T>
+RB_Node<T>::~RB_Node() {
+
+    RB_Node<T>::release(left);
+    RB_Node<T>::release(right);
+}
+
+template <typename T>
+void RB_Node<T>::release(RB_Node<T>* node) {
+
+    // rotate left children up until the subtree becomes a right chain, then free the chain
+    RB_Node<T> *temp = nullptr;
+    while(node != nullptr) {
+        if(node->left != nullptr) {
+            temp = node->left;
+            node->left = temp->right;
+            temp->right = node;
+            node = temp;
+        }
+        else {
+            temp = node->right;
+            node->right = nullptr;
+            delete node;
+            node = temp;
+        }
+    }
+}
+
+template <typename T>
+inline RB_Node<T>* RB_Node<T>::parent() const {
+    return reinterpret_cast<RB_Node<T>*>(parent_color & ~static_cast<uintptr_t>(1));
+}
+
+template <typename T>
+inline RB_Color RB_Node<T>::color() const {
+    return static_cast<RB_Color>(parent_color & 1);
+}
+
+template <typename T>
+inline bool RB_Node<T>::is_red() const {
+    return color() == RB_Color::RED;
+}
+
+template <typename T>
+inline void RB_Node<T>::set_parent(RB_Node<T>* node) {
+    parent_color = reinterpret_cast<uintptr_t>(node) | (parent_color & 1);
+}
+
+template <typename T>
+inline void RB_Node<T>::set_color(RB_Color color) {
+    parent_color = (parent_color & ~static_cast<uintptr_t>(1)) | static_cast<uintptr_t>(color);
+}
+
+template <typename T>
+void RB_Node<T>::preorder(std::ostream &os) {
+
+    std::stack<RB_Node<T>*> nodes;
+    nodes.push(this);
+
+    while(!nodes.empty()) {
+        RB_Node<T> *curr = nodes.top();
+        nodes.pop();
+
+        os << curr->element << ", ";
+        if(curr->right) nodes.push(curr->right);
+        if(curr->left)  nodes.push(curr->left);
+    }
+}
+
+template <typename T>
+void RB_Node<T>::inorder(std::ostream &os) {
+
+    std::stack<RB_Node<T>*> nodes;
+    RB_Node<T> *curr = this;
+
+    while(curr != nullptr || !nodes.empty()) {
+        while(curr != nullptr) {
+            nodes.push(curr);
+            curr = curr->left;
+        }
+
+        curr = nodes.top();
+        nodes.pop();
+        os << curr->element << ", ";
+        curr = curr->right;
+    }
+}
+
+template <typename T>
+void RB_Node<T>::postorder(std::ostream &os) {
+
+    std::stack<RB_Node<T>*> nodes;
+    RB_Node<T> *curr = this, *last = nullptr;
+
+    while(curr != nullptr || !nodes.empty()) {
+        while(curr != nullptr) {
+            nodes.push(curr);
+            curr = curr->left;
+        }
+
+        RB_Node<T> *top = nodes.top();
+        if(top->right != nullptr && top->right != last) {
+            curr = top->right;
+            continue;
+        }
+
+        os << top->element << ", ";
+        last = top;
+        nodes.pop();
+    }
+}
+
+template <typename T>
+void RB_Node<T>::show(std::ostream &os) {
+
+    std::stack<RB_Node<T>*> nodes;
+    nodes.push(this);
+
+    while(!nodes.empty()) {
+        RB_Node<T> *curr = nodes.top();
+        nodes.pop();
+
+        os << "Node(" << ((curr->is_red()) ? ("R") : ("B")) << "): "
+           << std::setw(4) << curr->element << ", ";
+
+        os << "Left: ";
+        if (!curr->left) os << "null";
+        else             os << std::setw(4) << curr->left->element;
+        os << ", ";
+
+        os << "Right: ";
+        if (!curr->right) os << "null";
+        else              os << std::setw(4) << curr->right->element;
+        os << std::endl;
+
+        if(curr->right) nodes.push(curr->right);
+        if(curr->left)  nodes.push(curr->left);
+    }
+}
+
+/* RB_Iterator */
+template <typename T>
+RB_Iterator<T>::RB_Iterator(RB_Node<T>* root, RB_Node<T>* curr)
+    : root(root), curr(curr) {}
+
+template <typename T>
+RB_Iterator<T>::reference RB_Iterator<T>::operator*() const {
+    return curr->element;
+}
+
+template <typename T>
+RB_Iterator<T>::pointer RB_Iterator<T>::operator->() const {
+    return &(curr->element);
+}
+
+template <typename T>
+RB_Iterator<T>& RB_Iterator<T>::operator++() {
+
+    assert(curr != nullptr);
+
+    if(curr->right != nullptr) {
+        curr = curr->right;
+        while(curr->left != nullptr) curr = curr->left;
+        return *this;
+    }
+
+    // climb while curr is a right child
+    RB_Node<T> *parent = curr->parent();
+    while(parent != nullptr && curr == parent->right) {
+        curr = parent;
+        parent = parent->parent();
+    }
+    curr = parent;
+    return *this;
+}
+
+template <typename T>
+RB_Iterator<T> RB_Iterator<T>::operator++(int) {
+
+    RB_Iterator<T> temp = *this;
+    ++(*this);
+    return temp;
+}
+
+template <typename T>
+RB_Iterator<T>& RB_Iterator<T>::operator--() {
+
+    if(curr == nullptr) {
+        curr = root;
+        while(curr != nullptr && curr->right != nullptr) curr = curr->right;
+        return *this;
+    }
+
+    if(curr->left != nullptr) {
+        curr = curr->left;
+        while(curr->right != nullptr) curr = curr->right;
+        return *this;
+    }
+
+    // climb while curr is a left child
+    RB_Node<T> *parent = curr->parent();
+    while(parent != nullptr && curr == parent->left) {
+        curr = parent;
+        parent = parent->parent();
+    }
+    curr = parent;
+    return *this;
+}
+
+template <typename T>
+RB_Iterator<T> RB_Iterator<T>::operator--(int) {
+
+    RB_Iterator<T> temp = *this;
+    --(*this);
+    return temp;
+}
+
+template <typename T>
+bool RB_Iterator<T>::operator==(const RB_Iterator<T> &other) const {
+    return curr == other.curr;
+}
+
+template <typename T>
+bool RB_Iterator<T>::operator!=(const RB_Iterator<T> &other) const {
+    return curr != other.curr;
+}
+
+/* RB_Tree */
+template <typename T>
+RB_Tree<T>::RB_Tree()
+    : root(nullptr),
+      num_nodes(0) {}
+
+template <typename T>
+template <typename Iter>
+RB_Tree<T>::RB_Tree(Iter first, Iter last) : RB_Tree() {
+
+    // bulk loading: sort the input if needed, then build a balanced tree in O(n)
+    std::vector<T> elements(first, last);
+    if(!std::is_sorted(elements.begin(), elements.end()))
+        std::sort(elements.begin(), elements.end());
+
+    if(std::adjacent_find(elements.begin(), elements.end()) != elements.end()) {
+        throw std::runtime_error("The element has been in the RB_Tree");
+    }
+
+    // halving keeps every leaf on the last two levels; the last level is red unless it is full
+    num_nodes = elements.size();
+    size_t red_depth = SIZE_MAX;
+    if(((num_nodes + 1) & num_nodes) != 0) {
+        red_depth = 0;
+        while((static_cast<size_t>(2) << red_depth) <= num_nodes) red_depth ++;
+    }
+    root = build(elements, 0, num_nodes, nullptr, 0, red_depth);
+    if(root != nullptr) root->set_color(RB_Color::BLACK);
+}
+
+template <typename T>
+RB_Tree<T>::~RB_Tree() {
+    RB_Node<T>::release(root);
+}
+
+template <typename T>
+RB_Tree<T>::Result RB_Tree<T>::get_min() const {
+
+    if(root == nullptr)
+        return nullptr;
+    return *begin();
+}
+
+template <typename T>
+RB_Tree<T>::Result RB_Tree<T>::get_max() const {
+
+    if(root == nullptr)
+        return nullptr;
+    return *(--end());
+}
+
+template <typename T>
+RB_Tree<T>::Pair_Result RB_Tree<T>::search_node(const T &ele) {
+
+    decltype(root) parent = nullptr, curr = root;
+    while(curr != nullptr && curr->element != ele) {
+
+        parent = curr;
+        if(curr->element < ele) curr = curr->right;
+        else                    curr = curr->left;
+    }
+
+    return {parent, curr};
+}
+
+template <typename T>
+void RB_Tree<T>::insert_node(const T &ele) {
+
+    bool go_left = false;
+    RB_Node<T> *parent = find_parent(ele, go_left);
+    attach(new RB_Node<T>(ele, parent), parent, go_left);
+}
+
+template <typename T>
+void RB_Tree<T>::insert_node(T &&ele) {
+
+    bool go_left = false;
+    RB_Node<T> *parent = find_parent(ele, go_left);
+    attach(new RB_Node<T>(std::move(ele), parent), parent, go_left);
+}
+
+template <typename T>
+void RB_Tree<T>::delete_node(const T ele) {
+
+    auto [parent, node] = search_node(ele);
+    if(node == nullptr)
+        return; // Not found
+
+    erase(node);
+}
+
+template <typename T>
+void RB_Tree<T>::modify_node(const T &ele, const T &new_ele) {
+
+    delete_node(ele);
+    insert_node(new_ele);
+}
+
+template <typename T>
+void RB_Tree<T>::modify_node(const T &ele, const T &&new_ele) {
+
+    delete_node(ele);
+    insert_node(std::move(new_ele));
+}
+
+template <typename T>
+void RB_Tree<T>::preorder(std::ostream &os) {
+
+    if(root != nullptr)
+        root->preorder(os);
+    os << std::endl;
+}
+
+template <typename T>
+void RB_Tree<T>::inorder(std::ostream &os) {
+
+    if(root != nullptr)
+        root->inorder(os);
+    os << std::endl;
+}
+
+template <typename T>
+void RB_Tree<T>::postorder(std::ostream &os) {
+
+    if(root != nullptr)
+        root->postorder(os);
+    os << std::endl;
+}
+
+template <typename T>
+void RB_Tree<T>::show(std::ostream &os) {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Height: " << std::setw(4) << height() << std::endl;
+
+    if(root != nullptr)
+        root->show(os);
+}
+
+template <typename T>
+inline bool RB_Tree<T>::empty() const {
+    return (size() == 0);
+}
+
+template <typename T>
+inline size_t RB_Tree<T>::size() const {
+    return num_nodes;
+}
+
+template <typename T>
+size_t RB_Tree<T>::height() const {
+
+    // nodes keep no height, count the levels
+    size_t levels = 0;
+    std::queue<RB_Node<T>*> nodes;
+    if(root != nullptr) nodes.push(root);
+
+    while(!nodes.empty()) {
+        for(size_t count = nodes.size(); count > 0; --count) {
+            RB_Node<T> *curr = nodes.front();
+            nodes.pop();
+            if(curr->left)  nodes.push(curr->left);
+            if(curr->right) nodes.push(curr->right);
+        }
+        levels ++;
+    }
+    return levels;
+}
+
+template <typename T>
+RB_Tree<T>::iterator RB_Tree<T>::begin() const {
+
+    RB_Node<T> *curr = root;
+    while(curr != nullptr && curr->left != nullptr) curr = curr->left;
+    return iterator(root, curr);
+}
+
+template <typename T>
+RB_Tree<T>::iterator RB_Tree<T>::end() const {
+    return iterator(root, nullptr);
+}
+
+template <typename T>
+RB_Tree<T>::iterator RB_Tree<T>::lower_bound(const T &ele) const {
+
+    // the first element >= ele
+    RB_Node<T> *result = nullptr, *curr = root;
+    while(curr != nullptr) {
+        if(curr->element < ele) curr = curr->right;
+        else                    { result = curr; curr = curr->left; }
+    }
+    return iterator(root, result);
+}
+
+template <typename T>
+RB_Tree<T>::iterator RB_Tree<T>::upper_bound(const T &ele) const {
+
+    // the first element > ele
+    RB_Node<T> *result = nullptr, *curr = root;
+    while(curr != nullptr) {
+        if(ele < curr->element) { result = curr; curr = curr->left; }
+        else                    curr = curr->right;
+    }
+    return iterator(root, result);
+}
+
+template <typename T>
+std::pair<typename RB_Tree<T>::iterator, typename RB_Tree<T>::iterator> RB_Tree<T>::equal_range(const T &ele) const {
+    return {lower_bound(ele), upper_bound(ele)};
+}
+
+template <typename T>
+template <typename Func>
+void RB_Tree<T>::for_each_in_range(const T &lo, const T &hi, Func fn) const {
+
+    // parent pointers make each step O(1) amortized, no stack is needed
+    for(iterator it = lower_bound(lo); it != end() && !(hi < *it); ++it)
+        fn(*it);
+}
+
+template <typename T>
+Eytzinger_Tree<T> RB_Tree<T>::freeze() const {
+    return Eytzinger_Tree<T>(begin(), end());
+}
+
+template <typename T>
+RB_Node<T>* RB_Tree<T>::build(std::vector<T> &elements, size_t lo, size_t hi, RB_Node<T>* parent, size_t depth, size_t red_depth) {
+
+    if(lo >= hi)
+        return nullptr;
+
+    size_t mid = lo + (hi - lo) / 2;
+    RB_Color color = (depth == red_depth) ? (RB_Color::RED) : (RB_Color::BLACK);
+    RB_Node<T> *node = new RB_Node<T>(std::move(elements[mid]), parent, color);
+
+    node->left  = build(elements, lo, mid, node, depth + 1, red_depth);
+    node->right = build(elements, mid + 1, hi, node, depth + 1, red_depth);
+    return node;
+}
+
+template <typename T>
+RB_Node<T>* RB_Tree<T>::find_parent(const T &ele, bool &go_left) const {
+
+    RB_Node<T> *parent = nullptr, *curr = root;
+    while(curr != nullptr) {
+        if(curr->element == ele) {
+            throw std::runtime_error("The element has been in the RB_Tree");
+        }
+
+        parent = curr;
+        go_left = (ele < curr->element);
+        curr = (go_left) ? (curr->left) : (curr->right);
+    }
+    return parent;
+}
+
+template <typename T>
+void RB_Tree<T>::attach(RB_Node<T>* node, RB_Node<T>* parent, bool go_left) {
+
+    if(parent == nullptr) root = node;
+    else if(go_left)      parent->left = node;
+    else                  parent->right = node;
+
+    num_nodes ++;
+    insert_fixup(node);
+}
+
+template <typename T>
+void RB_Tree<T>::left_rotate(RB_Node<T>* node) {
+
+    RB_Node<T> *child = node->right;
+    node->right = child->left;
+    if(child->left != nullptr) child->left->set_parent(node);
+
+    replace_child(node->parent(), node, child);
+    child->left = node;
+    node->set_parent(child);
+}
+
+template <typename T>
+void RB_Tree<T>::right_rotate(RB_Node<T>* node) {
+
+    RB_Node<T> *child = node->left;
+    node->left = child->right;
+    if(child->right != nullptr) child->right->set_parent(node);
+
+    replace_child(node->parent(), node, child);
+    child->right = node;
+    node->set_parent(child);
+}
+
+template <typename T>
+void RB_Tree<T>::replace_child(RB_Node<T>* parent, RB_Node<T>* old_child, RB_Node<T>* new_child) {
+
+    if(parent == nullptr)              root = new_child;
+    else if(parent->left == old_child) parent->left = new_child;
+    else                               parent->right = new_child;
+
+    if(new_child != nullptr) new_child->set_parent(parent);
+}
+
+template <typename T>
+void RB_Tree<T>::insert_fixup(RB_Node<T>* node) {
+
+    // a red uncle only recolors and moves up, a black uncle ends with at most two rotations
+    while(node->parent() != nullptr && node->parent()->is_red()) {
+        RB_Node<T> *parent = node->parent(), *grand = parent->parent();
+
+        if(parent == grand->left) {
+            RB_Node<T> *uncle = grand->right;
+            if(uncle != nullptr && uncle->is_red()) {
+                parent->set_color(RB_Color::BLACK);
+                uncle->set_color(RB_Color::BLACK);
+                grand->set_color(RB_Color::RED);
+                node = grand;
+                continue;
+            }
+
+            if(node == parent->right) {
+                left_rotate(parent);
+                std::swap(node, parent);
+            }
+            parent->set_color(RB_Color::BLACK);
+            grand->set_color(RB_Color::RED);
+            right_rotate(grand);
+        }
+        else {
+            RB_Node<T> *uncle = grand->left;
+            if(uncle != nullptr && uncle->is_red()) {
+                parent->set_color(RB_Color::BLACK);
+                uncle->set_color(RB_Color::BLACK);
+                grand->set_color(RB_Color::RED);
+                node = grand;
+                continue;
+            }
+
+            if(node == parent->left) {
+                right_rotate(parent);
+                std::swap(node, parent);
+            }
+            parent->set_color(RB_Color::BLACK);
+            grand->set_color(RB_Color::RED);
+            left_rotate(grand);
+        }
+    }
+    root->set_color(RB_Color::BLACK);
+}
+
+template <typename T>
+void RB_Tree<T>::erase(RB_Node<T>* node) {
+
+    // a node with two children swaps places with its successor, then at most one child remains
+    RB_Node<T> *child = nullptr, *parent = nullptr;
+    RB_Color removed = node->color();
+
+    if(node->left == nullptr || node->right == nullptr) {
+        child = (node->left != nullptr) ? (node->left) : (node->right);
+        parent = node->parent();
+        replace_child(parent, node, child);
+    }
+    else {
+        RB_Node<T> *succ = node->right;
+        while(succ->left != nullptr) succ = succ->left;
+
+        removed = succ->color();
+        child = succ->right;
+
+        if(succ->parent() == node) {
+            parent = succ;
+        }
+        else {
+            parent = succ->parent();
+            replace_child(parent, succ, child);
+            succ->right = node->right;
+            succ->right->set_parent(succ);
+        }
+
+        replace_child(node->parent(), node, succ);
+        succ->left = node->left;
+        succ->left->set_parent(succ);
+        succ->set_color(node->color());
+    }
+
+    node->left = node->right = nullptr;
+    delete node;
+    num_nodes --;
+
+    if(removed == RB_Color::BLACK)
+        erase_fixup(child, parent);
+}
+
+template <typename T>
+void RB_Tree<T>::erase_fixup(RB_Node<T>* node, RB_Node<T>* parent) {
+
+    // node carries an extra black; node may be nullptr, so its parent is passed along
+    while(node != root && (node == nullptr || !node->is_red())) {
+        if(node == parent->left) {
+            RB_Node<T> *sibling = parent->right;
+            if(sibling->is_red()) {
+                sibling->set_color(RB_Color::BLACK);
+                parent->set_color(RB_Color::RED);
+                left_rotate(parent);
+                sibling = parent->right;
+            }
+
+            bool left_black  = (sibling->left  == nullptr || !sibling->left->is_red());
+            bool right_black = (sibling->right == nullptr || !sibling->right->is_red());
+            if(left_black && right_black) {
+                sibling->set_color(RB_Color::RED);
+                node = parent;
+                parent = node->parent();
+                continue;
+            }
+
+            if(right_black) {
+                sibling->left->set_color(RB_Color::BLACK);
+                sibling->set_color(RB_Color::RED);
+                right_rotate(sibling);
+                sibling = parent->right;
+            }
+            sibling->set_color(parent->color());
+            parent->set_color(RB_Color::BLACK);
+            sibling->right->set_color(RB_Color::BLACK);
+            left_rotate(parent);
+            node = root;
+        }
+        else {
+            RB_Node<T> *sibling = parent->left;
+            if(sibling->is_red()) {
+                sibling->set_color(RB_Color::BLACK);
+                parent->set_color(RB_Color::RED);
+                right_rotate(parent);
+                sibling = parent->left;
+            }
+
+            bool left_black  = (sibling->left  == nullptr || !sibling->left->is_red());
+            bool right_black = (sibling->right == nullptr || !sibling->right->is_red());
+            if(left_black && right_black) {
+                sibling->set_color(RB_Color::RED);
+                node = parent;
+                parent = node->parent();
+                continue;
+            }
+
+            if(left_black) {
+                sibling->right->set_color(RB_Color::BLACK);
+                sibling->set_color(RB_Color::RED);
+                left_rotate(sibling);
+                sibling = parent->left;
+            }
+            sibling->set_color(parent->color());
+            parent->set_color(RB_Color::BLACK);
+            sibling->left->set_color(RB_Color::BLACK);
+            right_rotate(parent);
+            node = root;
+        }
+    }
+    if(node != nullptr) node->set_color(RB_Color::BLACK);
+}
+
+}
@@ -0,0 +1,322 @@
+#pragma once
+
+#include "../element.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <utility>
+#include <optional>
+#include <limits>
+#include <span>
+#include <vector>
+#include <bit>
+#include <type_traits>
+
+/* Declaration */
+/*
+ * Iterative lazy segment tree over a Policy:
+ *   value_type, tag_type
+ *   identity()                  the neutral value of combine
+ *   combine(a, b)               associative, a covers the left part
+ *   tag_identity()              the tag that changes nothing
+ *   apply(tag, value, length)   the tag applied to a value covering length slots
+ *   compose(tag, old)           the tag equal to applying old first, then tag
+ * Segment_Tree(n) fills every slot with identity(). For the min policies that is the maximum
+ * of T, an empty slot: Range_Add_Min leaves it unchanged rather than adding to it, which would
+ * overflow, and Range_Assign_Min overwrites it with the assigned value.
+ */
+namespace ds_imp {
+
+template <typename T>
+inline T max_value() {
+    if constexpr (std::is_same_v<T, Element>) return MAX_ELEMENT;
+    else                                       return std::numeric_limits<T>::max();
+}
+
+template <typename T>
+struct Range_Add_Sum {
+    using value_type = T;
+    using tag_type = T;
+
+    static T identity() { return T(0); }
+    static T combine(const T &a, const T &b) { return a + b; }
+    static T tag_identity() { return T(0); }
+    static T apply(const T &tag, const T &value, size_t length) { return value + tag * static_cast<T>(length); }
+    static T compose(const T &tag, const T &old) { return tag + old; }
+};
+
+template <typename T>
+struct Range_Add_Min {
+    using value_type = T;
+    using tag_type = T;
+
+    static T identity() { return max_value<T>(); }
+    static T combine(const T &a, const T &b) { return (b < a) ? (b) : (a); }
+    static T tag_identity() { return T(0); }
+    static T apply(const T &tag, const T &value, size_t) { return (value == identity()) ? (value) : (value + tag); }
+    static T compose(const T &tag, const T &old) { return tag + old; }
+};
+
+template <typename T>
+struct Range_Assign_Sum {
+    using value_type = T;
+    using tag_type = std::optional<T>;
+
+    static T identity() { return T(0); }
+    static T combine(const T &a, const T &b) { return a + b; }
+    static tag_type tag_identity() { return std::nullopt; }
+    static T apply(const tag_type &tag, const T &value, size_t length) { return (tag) ? (*tag * static_cast<T>(length)) : (value); }
+    static tag_type compose(const tag_type &tag, const tag_type &old) { return (tag) ? (tag) : (old); }
+};
+
+template <typename T>
+struct Range_Assign_Min {
+    using value_type = T;
+    using tag_type = std::optional<T>;
+
+    static T identity() { return max_value<T>(); }
+    static T combine(const T &a, const T &b) { return (b < a) ? (b) : (a); }
+    static tag_type tag_identity() { return std::nullopt; }
+    static T apply(const tag_type &tag, const T &value, size_t) { return (tag) ? (*tag) : (value); }
+    static tag_type compose(const tag_type &tag, const tag_type &old) { return (tag) ? (tag) : (old); }
+};
+
+template <typename Policy>
+class Segment_Tree {
+
+    using T = typename Policy::value_type;
+    using Tag = typename Policy::tag_type;
+
+    public:
+        Segment_Tree(size_t n = 0);
+        template <typename Iter>
+        Segment_Tree(Iter first, Iter last);
+        ~Segment_Tree();
+
+        T get(size_t i);
+        void set(size_t i, const T &value);
+        T query(size_t l, size_t r);
+        std::vector<T> query(std::span<const std::pair<size_t, size_t>> ranges);
+        inline T query_all() const;
+        void apply(size_t l, size_t r, const Tag &tag);
+        void show(std::ostream &os);
+        inline bool empty() const;
+        inline size_t size() const;
+
+    private:
+        size_t num_slots;               // n
+        size_t leaves;                  // n rounded up to a power of two
+        size_t levels;                  // log2(leaves)
+        bool pending;                   // some tag has not been pushed down
+        std::vector<T> data;            // data[1] is the root, data[leaves + i] is slot i
+        std::vector<Tag> lazy;          // lazy[k] is owed to both children of k
+
+        inline size_t length(size_t k) const;
+        inline void update(size_t k);
+        inline void apply_node(size_t k, const Tag &tag);
+        inline void push(size_t k);
+        void push_all();
+        T fold(size_t l, size_t r) const;
+        void check_range(size_t l, size_t r) const;
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+template <typename Policy>
+Segment_Tree<Policy>::Segment_Tree(size_t n)
+    : num_slots(n),
+      leaves(std::bit_ceil(std::max<size_t>(n, 1))),
+      levels(std::countr_zero(leaves)),
+      pending(false),
+      data(2 * leaves, Policy::identity()),
+      lazy(leaves, Policy::tag_identity()) {}
+
+template <typename Policy>
+template <typename Iter>
+Segment_Tree<Policy>::Segment_Tree(Iter first, Iter last) : Segment_Tree(static_cast<size_t>(std::distance(first, last))) {
+
+    // O(n): fill the leaves, then every inner node once from the bottom up
+    for(size_t i = 0; first != last; ++first, ++i)
+        data[leaves + i] = *first;
+    for(size_t k = leaves - 1; k >= 1; --k)
+        update(k);
+}
+
+template <typename Policy>
+Segment_Tree<Policy>::~Segment_Tree() = default;
+
+template <typename Policy>
+Segment_Tree<Policy>::T Segment_Tree<Policy>::get(size_t i) {
+
+    check_range(i, i + 1);
+    i += leaves;
+    for(size_t h = levels; h >= 1; --h)
+        push(i >> h);
+    return data[i];
+}
+
+template <typename Policy>
+void Segment_Tree<Policy>::set(size_t i, const T &value) {
+
+    check_range(i, i + 1);
+    i += leaves;
+    for(size_t h = levels; h >= 1; --h)
+        push(i >> h);
+
+    data[i] = value;
+    for(size_t h = 1; h <= levels; ++h)
+        update(i >> h);
+}
+
+template <typename Policy>
+Segment_Tree<Policy>::T Segment_Tree<Policy>::query(size_t l, size_t r) {
+
+    // combine of the slots [l, r)
+    check_range(l, r);
+    if(l == r)
+        return Policy::identity();
+
+    l += leaves;
+    r += leaves;
+    if(pending) {
+        // only the ancestors of the two boundaries can hold tags owed to nodes the fold reads
+        for(size_t h = levels; h >= 1; --h) {
+            if(((l >> h) << h) != l) push(l >> h);
+            if(((r >> h) << h) != r) push((r - 1) >> h);
+        }
+    }
+    return fold(l, r);
+}
+
+template <typename Policy>
+std::vector<typename Segment_Tree<Policy>::T> Segment_Tree<Policy>::query(std::span<const std::pair<size_t, size_t>> ranges) {
+
+    // a large batch pays O(n) once to push every tag down, then each query is a read-only fold
+    std::vector<T> results;
+    results.reserve(ranges.size());
+
+    if(pending && ranges.size() * levels >= leaves)
+        push_all();
+
+    for(const auto &[l, r] : ranges)
+        results.push_back(query(l, r));
+    return results;
+}
+
+template <typename Policy>
+inline Segment_Tree<Policy>::T Segment_Tree<Policy>::query_all() const {
+    return data[1];
+}
+
+template <typename Policy>
+void Segment_Tree<Policy>::apply(size_t l, size_t r, const Tag &tag) {
+
+    // tag every slot of [l, r)
+    check_range(l, r);
+    if(l == r)
+        return;
+
+    l += leaves;
+    r += leaves;
+    for(size_t h = levels; h >= 1; --h) {
+        if(((l >> h) << h) != l) push(l >> h);
+        if(((r >> h) << h) != r) push((r - 1) >> h);
+    }
+
+    for(size_t lo = l, hi = r; lo < hi; lo >>= 1, hi >>= 1) {
+        if(lo & 1) apply_node(lo ++, tag);
+        if(hi & 1) apply_node(-- hi, tag);
+    }
+
+    for(size_t h = 1; h <= levels; ++h) {
+        if(((l >> h) << h) != l) update(l >> h);
+        if(((r >> h) << h) != r) update((r - 1) >> h);
+    }
+    pending = true;
+}
+
+template <typename Policy>
+void Segment_Tree<Policy>::show(std::ostream &os) {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Leaves: " << std::setw(4) << leaves << std::endl;
+
+    push_all();
+    for(size_t i = 0; i < num_slots; ++i)
+        os << data[leaves + i] << ", ";
+    os << std::endl;
+}
+
+template <typename Policy>
+inline bool Segment_Tree<Policy>::empty() const {
+    return (size() == 0);
+}
+
+template <typename Policy>
+inline size_t Segment_Tree<Policy>::size() const {
+    return num_slots;
+}
+
+template <typename Policy>
+inline size_t Segment_Tree<Policy>::length(size_t k) const {
+    return leaves >> (std::bit_width(k) - 1);
+}
+
+template <typename Policy>
+inline void Segment_Tree<Policy>::update(size_t k) {
+    data[k] = Policy::combine(data[2 * k], data[2 * k + 1]);
+}
+
+template <typename Policy>
+inline void Segment_Tree<Policy>::apply_node(size_t k, const Tag &tag) {
+
+    data[k] = Policy::apply(tag, data[k], length(k));
+    if(k < leaves) lazy[k] = Policy::compose(tag, lazy[k]);
+}
+
+template <typename Policy>
+inline void Segment_Tree<Policy>::push(size_t k) {
+
+    apply_node(2 * k, lazy[k]);
+    apply_node(2 * k + 1, lazy[k]);
+    lazy[k] = Policy::tag_identity();
+}
+
+template <typename Policy>
+void Segment_Tree<Policy>::push_all() {
+
+    // parents come before children in the array, so one forward pass clears every tag
+    if(!pending)
+        return;
+
+    for(size_t k = 1; k < leaves; ++k)
+        push(k);
+    pending = false;
+}
+
+template <typename Policy>
+Segment_Tree<Policy>::T Segment_Tree<Policy>::fold(size_t l, size_t r) const {
+
+    T left = Policy::identity(), right = Policy::identity();
+    for(; l < r; l >>= 1, r >>= 1) {
+        if(l & 1) left  = Policy::combine(left, data[l ++]);
+        if(r & 1) right = Policy::combine(data[-- r], right);
+    }
+    return Policy::combine(left, right);
+}
+
+template <typename Policy>
+void Segment_Tree<Policy>::check_range(size_t l, size_t r) const {
+
+    if(l > r || r > num_slots) {
+        throw std::out_of_range("The range is out of the Segment_Tree");
+    }
+}
+
+}
@@ -0,0 +1,664 @@
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <stack>
+#include <queue>
+#include <algorithm>
+
+/* Declaration */
+namespace ds_imp {
+
+template <typename T>
+struct Splay_Node {
+    T element;
+    Splay_Node<T> *left;
+    Splay_Node<T> *right;
+
+    /* Constructor */
+    Splay_Node(const T &ele = T(), Splay_Node<T>* left = nullptr, Splay_Node<T>* right = nullptr);
+    Splay_Node(T &&ele, Splay_Node<T>* left = nullptr, Splay_Node<T>* right = nullptr);
+
+    /* Destructor */
+    ~Splay_Node();
+
+    static size_t release(Splay_Node<T>* node);
+    static Splay_Node<T>* splay(Splay_Node<T>* node, const T &ele);
+
+    void preorder(std::ostream &os);
+    void inorder(std::ostream &os);
+    void postorder(std::ostream &os);
+    void show(std::ostream &os);
+};
+
+template <typename T>
+class Splay_Tree {
+
+    using Result = std::variant<std::nullptr_t, T>;
+
+    public:
+        Splay_Tree();
+        template <typename Iter>
+        Splay_Tree(Iter first, Iter last);
+        ~Splay_Tree();
+
+        Splay_Tree(const Splay_Tree<T> &other) = delete;
+        Splay_Tree<T>& operator=(const Splay_Tree<T> &other) = delete;
+        Splay_Tree(Splay_Tree<T> &&other) noexcept;
+        Splay_Tree<T>& operator=(Splay_Tree<T> &&other) noexcept;
+
+        Result get_min() const;
+        Result get_max() const;
+        Result search_node(const T &ele);
+        Result lower_bound(const T &ele);
+        void insert_node(const T  &ele);
+        void insert_node(T &&ele);
+        void delete_node(const T ele);
+        void modify_node(const T &ele, const T &new_ele);
+        void modify_node(const T &ele, const T &&new_ele);
+        Splay_Tree<T> split(const T &ele);
+        void join(Splay_Tree<T> &&other);
+        void erase_range(const T &lo, const T &hi);
+        template <typename Func>
+        void for_each_in_range(const T &lo, const T &hi, Func fn) const;
+        void preorder(std::ostream &os);
+        void inorder(std::ostream &os);
+        void postorder(std::ostream &os);
+        void show(std::ostream &os);
+        inline bool empty() const;
+        inline size_t size() const;
+        size_t height() const;
+
+    private:
+        Splay_Node<T> *root;
+        size_t num_nodes;
+
+        Splay_Node<T>* build(std::vector<T> &elements, size_t lo, size_t hi);
+        template <typename U>
+        void insert_impl(U &&ele);
+        Splay_Node<T>* cut(const T &ele);
+        static size_t count_nodes(Splay_Node<T>* node);
+};
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+/* Splay_Node */
+template <typename T>
+Splay_Node<T>::Splay_Node(const T &ele, Splay_Node<T>* left, Splay_Node<T>* right)
+    : element(ele), left(left), right(right) {}
+
+template <typename T>
+Splay_Node<T>::Splay_Node(T &&ele, Splay_Node<T>* left, Splay_Node<T>* right)
+    : element(std::move(ele)), left(left), right(right) {}
+
+template <typename T>
+Splay_Node<T>::~Splay_Node() {
+
+    Splay_Node<T>::release(left);
+    Splay_Node<T>::release(right);
+}
+
+template <typename T>
+size_t Splay_Node<T>::release(Splay_Node<T>* node) {
+
+    // rotate left children up until the subtree becomes a right chain, then free the chain
+    size_t count = 0;
+    Splay_Node<T> *temp = nullptr;
+    while(node != nullptr) {
+        if(node->left != nullptr) {
+            temp = node->left;
+            node->left = temp->right;
+            temp->right = node;
+            node = temp;
+        }
+        else {
+            temp = node->right;
+            node->right = nullptr;
+            delete node;
+            node = temp;
+            count ++;
+        }
+    }
+    return count;
+}
+
+template <typename T>
+Splay_Node<T>* Splay_Node<T>::splay(Splay_Node<T>* node, const T &ele) {
+
+    // top-down splay: nodes passed on the way down hang off the left and right trees,
+    // which are reassembled under the last node reached. It is ele or its neighbour in order.
+    if(node == nullptr)
+        return nullptr;
+
+    Splay_Node<T> *left_tree = nullptr, *right_tree = nullptr;
+    Splay_Node<T> **left_hook = &left_tree, **right_hook = &right_tree;
+
+    while(true) {
+        if(ele < node->element) {
+            if(node->left == nullptr) break;
+            if(ele < node->left->element) {
+                // zig-zig: rotate right first
+                Splay_Node<T> *temp = node->left;
+                node->left = temp->right;
+                temp->right = node;
+                node = temp;
+                if(node->left == nullptr) break;
+            }
+            *right_hook = node;
+            right_hook = &(node->left);
+            node = node->left;
+        }
+        else if(node->element < ele) {
+            if(node->right == nullptr) break;
+            if(node->right->element < ele) {
+                // zag-zag: rotate left first
+                Splay_Node<T> *temp = node->right;
+                node->right = temp->left;
+                temp->left = node;
+                node = temp;
+                if(node->right == nullptr) break;
+            }
+            *left_hook = node;
+            left_hook = &(node->right);
+            node = node->right;
+        }
+        else break;
+    }
+
+    *left_hook = node->left;
+    *right_hook = node->right;
+    node->left = left_tree;
+    node->right = right_tree;
+    return node;
+}
+
+template <typename T>
+void Splay_Node<T>::preorder(std::ostream &os) {
+
+    std::stack<Splay_Node<T>*> nodes;
+    nodes.push(this);
+
+    while(!nodes.empty()) {
+        Splay_Node<T> *curr = nodes.top();
+        nodes.pop();
+
+        os << curr->element << ", ";
+        if(curr->right) nodes.push(curr->right);
+        if(curr->left)  nodes.push(curr->left);
+    }
+}
+
+template <typename T>
+void Splay_Node<T>::inorder(std::ostream &os) {
+
+    std::stack<Splay_Node<T>*> nodes;
+    Splay_Node<T> *curr = this;
+
+    while(curr != nullptr || !nodes.empty()) {
+        while(curr != nullptr) {
+            nodes.push(curr);
+            curr = curr->left;
+        }
+
+        curr = nodes.top();
+        nodes.pop();
+        os << curr->element << ", ";
+        curr = curr->right;
+    }
+}
+
+template <typename T>
+void Splay_Node<T>::postorder(std::ostream &os) {
+
+    std::stack<Splay_Node<T>*> nodes;
+    Splay_Node<T> *curr = this, *last = nullptr;
+
+    while(curr != nullptr || !nodes.empty()) {
+        while(curr != nullptr) {
+            nodes.push(curr);
+            curr = curr->left;
+        }
+
+        Splay_Node<T> *top = nodes.top();
+        if(top->right != nullptr && top->right != last) {
+            curr = top->right;
+            continue;
+        }
+
+        os << top->element << ", ";
+        last = top;
+        nodes.pop();
+    }
+}
+
+template <typename T>
+void Splay_Node<T>::show(std::ostream &os) {
+
+    std::stack<Splay_Node<T>*> nodes;
+    nodes.push(this);
+
+    while(!nodes.empty()) {
+        Splay_Node<T> *curr = nodes.top();
+        nodes.pop();
+
+        os << "Node: " << std::setw(4) << curr->element << ", ";
+
+        os << "Left: ";
+        if (!curr->left) os << "null";
+        else             os << std::setw(4) << curr->left->element;
+        os << ", ";
+
+        os << "Right: ";
+        if (!curr->right) os << "null";
+        else              os << std::setw(4) << curr->right->element;
+        os << std::endl;
+
+        if(curr->right) nodes.push(curr->right);
+        if(curr->left)  nodes.push(curr->left);
+    }
+}
+
+/* Splay_Tree */
+template <typename T>
+Splay_Tree<T>::Splay_Tree()
+    : root(nullptr),
+      num_nodes(0) {}
+
+template <typename T>
+template <typename Iter>
+Splay_Tree<T>::Splay_Tree(Iter first, Iter last) : Splay_Tree() {
+
+    // bulk loading: sort the input if needed, then build a balanced tree in O(n)
+    std::vector<T> elements(first, last);
+    if(!std::is_sorted(elements.begin(), elements.end()))
+        std::sort(elements.begin(), elements.end());
+
+    if(std::adjacent_find(elements.begin(), elements.end()) != elements.end()) {
+        throw std::runtime_error("The element has been in the Splay_Tree");
+    }
+
+    num_nodes = elements.size();
+    root = build(elements, 0, num_nodes);
+}
+
+template <typename T>
+Splay_Tree<T>::~Splay_Tree() {
+    Splay_Node<T>::release(root);
+}
+
+template <typename T>
+Splay_Tree<T>::Splay_Tree(Splay_Tree<T> &&other) noexcept
+    : root(other.root),
+      num_nodes(other.num_nodes) {
+
+    other.root = nullptr;
+    other.num_nodes = 0;
+}
+
+template <typename T>
+Splay_Tree<T>& Splay_Tree<T>::operator=(Splay_Tree<T> &&other) noexcept {
+
+    if(this == &other) return *this;
+
+    Splay_Node<T>::release(root);
+    root = other.root;
+    num_nodes = other.num_nodes;
+    other.root = nullptr;
+    other.num_nodes = 0;
+    return *this;
+}
+
+template <typename T>
+Splay_Tree<T>::Result Splay_Tree<T>::get_min() const {
+
+    if(root == nullptr)
+        return nullptr;
+
+    Splay_Node<T> *curr = root;
+    while(curr->left != nullptr) curr = curr->left;
+    return curr->element;
+}
+
+template <typename T>
+Splay_Tree<T>::Result Splay_Tree<T>::get_max() const {
+
+    if(root == nullptr)
+        return nullptr;
+
+    Splay_Node<T> *curr = root;
+    while(curr->right != nullptr) curr = curr->right;
+    return curr->element;
+}
+
+template <typename T>
+Splay_Tree<T>::Result Splay_Tree<T>::search_node(const T &ele) {
+
+    // the found element, or its neighbour on a miss, becomes the root
+    root = Splay_Node<T>::splay(root, ele);
+    if(root == nullptr || root->element != ele)
+        return nullptr;
+    return root->element;
+}
+
+template <typename T>
+Splay_Tree<T>::Result Splay_Tree<T>::lower_bound(const T &ele) {
+
+    // the first element >= ele, the root after splaying is either it or its predecessor
+    root = Splay_Node<T>::splay(root, ele);
+    if(root == nullptr)
+        return nullptr;
+    if(!(root->element < ele))
+        return root->element;
+
+    Splay_Node<T> *curr = root->right;
+    if(curr == nullptr)
+        return nullptr;
+    while(curr->left != nullptr) curr = curr->left;
+    return curr->element;
+}
+
+template <typename T>
+void Splay_Tree<T>::insert_node(const T &ele) {
+    insert_impl(ele);
+}
+
+template <typename T>
+void Splay_Tree<T>::insert_node(T &&ele) {
+    insert_impl(std::move(ele));
+}
+
+template <typename T>
+void Splay_Tree<T>::delete_node(const T ele) {
+
+    root = Splay_Node<T>::splay(root, ele);
+    if(root == nullptr || root->element != ele)
+        return; // Not found
+
+    // every key on the left is smaller, so splaying ele there brings up its maximum
+    Splay_Node<T> *node = root;
+    if(node->left == nullptr) {
+        root = node->right;
+    }
+    else {
+        root = Splay_Node<T>::splay(node->left, ele);
+        root->right = node->right;
+    }
+
+    node->left = node->right = nullptr;
+    delete node;
+    num_nodes --;
+}
+
+template <typename T>
+void Splay_Tree<T>::modify_node(const T &ele, const T &new_ele) {
+
+    delete_node(ele);
+    insert_node(new_ele);
+}
+
+template <typename T>
+void Splay_Tree<T>::modify_node(const T &ele, const T &&new_ele) {
+
+    delete_node(ele);
+    insert_node(std::move(new_ele));
+}
+
+template <typename T>
+Splay_Tree<T> Splay_Tree<T>::split(const T &ele) {
+
+    // this keeps the elements < ele, the returned tree takes the elements >= ele.
+    // The returned part is counted by a walk, so split costs O(its size) on top of the splay.
+    Splay_Tree<T> greater;
+    greater.root = cut(ele);
+    greater.num_nodes = count_nodes(greater.root);
+    num_nodes -= greater.num_nodes;
+    return greater;
+}
+
+template <typename T>
+void Splay_Tree<T>::join(Splay_Tree<T> &&other) {
+
+    // every element of other must be greater than every element of this
+    if(other.root == nullptr)
+        return;
+
+    if(root == nullptr) {
+        std::swap(root, other.root);
+        std::swap(num_nodes, other.num_nodes);
+        return;
+    }
+
+    Splay_Node<T> *max_node = root;
+    while(max_node->right != nullptr) max_node = max_node->right;
+    Splay_Node<T> *min_node = other.root;
+    while(min_node->left != nullptr) min_node = min_node->left;
+
+    if(!(max_node->element < min_node->element)) {
+        throw std::runtime_error("The joined Splay_Tree must hold greater elements");
+    }
+
+    root = Splay_Node<T>::splay(root, max_node->element);
+    root->right = other.root;
+    num_nodes += other.num_nodes;
+    other.root = nullptr;
+    other.num_nodes = 0;
+}
+
+template <typename T>
+void Splay_Tree<T>::erase_range(const T &lo, const T &hi) {
+
+    // cut out [lo, hi] with two splits and free the middle part
+    if(hi < lo)
+        return;
+
+    // only the freed part is counted, so the cost is O(log n + k) amortized for k erased elements
+    Splay_Node<T> *node = cut(lo), *rest = nullptr;
+    root = Splay_Node<T>::splay(root, lo);
+
+    node = Splay_Node<T>::splay(node, hi);
+    if(node != nullptr) {
+        if(hi < node->element) {
+            rest = node;
+            node = node->left;
+            rest->left = nullptr;
+        }
+        else {
+            rest = node->right;
+            node->right = nullptr;
+        }
+    }
+
+    num_nodes -= Splay_Node<T>::release(node);
+
+    if(root == nullptr) {
+        root = rest;
+    }
+    else {
+        // the root holds the maximum of the lower part after splaying lo on it
+        root->right = rest;
+    }
+}
+
+template <typename T>
+template <typename Func>
+void Splay_Tree<T>::for_each_in_range(const T &lo, const T &hi, Func fn) const {
+
+    // in-order walk with an explicit stack, skipping subtrees outside [lo, hi]; no splaying
+    std::stack<Splay_Node<T>*> nodes;
+    Splay_Node<T> *curr = root;
+
+    while(curr != nullptr || !nodes.empty()) {
+        while(curr != nullptr) {
+            if(curr->element < lo) {
+                curr = curr->right;
+                continue;
+            }
+            nodes.push(curr);
+            curr = curr->left;
+        }
+
+        if(nodes.empty())
+            break;
+
+        curr = nodes.top();
+        nodes.pop();
+        if(hi < curr->element)
+            return;
+
+        fn(curr->element);
+        curr = curr->right;
+    }
+}
+
+template <typename T>
+void Splay_Tree<T>::preorder(std::ostream &os) {
+
+    if(root != nullptr)
+        root->preorder(os);
+    os << std::endl;
+}
+
+template <typename T>
+void Splay_Tree<T>::inorder(std::ostream &os) {
+
+    if(root != nullptr)
+        root->inorder(os);
+    os << std::endl;
+}
+
+template <typename T>
+void Splay_Tree<T>::postorder(std::ostream &os) {
+
+    if(root != nullptr)
+        root->postorder(os);
+    os << std::endl;
+}
+
+template <typename T>
+void Splay_Tree<T>::show(std::ostream &os) {
+
+    os << "Size: " << std::setw(4) << size() << ", ";
+    os << "Height: " << std::setw(4) << height() << std::endl;
+
+    if(root != nullptr)
+        root->show(os);
+}
+
+template <typename T>
+inline bool Splay_Tree<T>::empty() const {
+    return (size() == 0);
+}
+
+template <typename T>
+inline size_t Splay_Tree<T>::size() const {
+    return num_nodes;
+}
+
+template <typename T>
+size_t Splay_Tree<T>::height() const {
+
+    // nodes keep no height, count the levels
+    size_t levels = 0;
+    std::queue<Splay_Node<T>*> nodes;
+    if(root != nullptr) nodes.push(root);
+
+    while(!nodes.empty()) {
+        for(size_t count = nodes.size(); count > 0; --count) {
+            Splay_Node<T> *curr = nodes.front();
+            nodes.pop();
+            if(curr->left)  nodes.push(curr->left);
+            if(curr->right) nodes.push(curr->right);
+        }
+        levels ++;
+    }
+    return levels;
+}
+
+template <typename T>
+Splay_Node<T>* Splay_Tree<T>::build(std::vector<T> &elements, size_t lo, size_t hi) {
+
+    if(lo >= hi)
+        return nullptr;
+
+    size_t mid = lo + (hi - lo) / 2;
+    Splay_Node<T> *left  = build(elements, lo, mid);
+    Splay_Node<T> *right = build(elements, mid + 1, hi);
+    return new Splay_Node<T>(std::move(elements[mid]), left, right);
+}
+
+template <typename T>
+template <typename U>
+void Splay_Tree<T>::insert_impl(U &&ele) {
+
+    // splay the neighbour of ele to the root, then put the new node above it
+    root = Splay_Node<T>::splay(root, ele);
+    if(root != nullptr && root->element == ele) {
+        throw std::runtime_error("The element has been in the Splay_Tree");
+    }
+
+    Splay_Node<T> *node = new Splay_Node<T>(std::forward<U>(ele));
+    if(root != nullptr) {
+        if(node->element < root->element) {
+            node->left = root->left;
+            node->right = root;
+            root->left = nullptr;
+        }
+        else {
+            node->right = root->right;
+            node->left = root;
+            root->right = nullptr;
+        }
+    }
+
+    root = node;
+    num_nodes ++;
+}
+
+template <typename T>
+Splay_Node<T>* Splay_Tree<T>::cut(const T &ele) {
+
+    // detaches and returns the elements >= ele; num_nodes is left for the caller to fix
+    root = Splay_Node<T>::splay(root, ele);
+    if(root == nullptr)
+        return nullptr;
+
+    Splay_Node<T> *greater = nullptr;
+    if(root->element < ele) {
+        greater = root->right;
+        root->right = nullptr;
+    }
+    else {
+        greater = root;
+        root = root->left;
+        greater->left = nullptr;
+    }
+    return greater;
+}
+
+template <typename T>
+size_t Splay_Tree<T>::count_nodes(Splay_Node<T>* node) {
+
+    size_t count = 0;
+    std::stack<Splay_Node<T>*> nodes;
+    if(node != nullptr) nodes.push(node);
+
+    while(!nodes.empty()) {
+        Splay_Node<T> *curr = nodes.top();
+        nodes.pop();
+        count ++;
+        if(curr->left)  nodes.push(curr->left);
+        if(curr->right) nodes.push(curr->right);
+    }
+    return count;
+}
+
+}
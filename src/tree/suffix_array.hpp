@@ -0,0 +1,316 @@
+#pragma once
+
+#include "../others/mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <stdexcept>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <optional>
+#include <vector>
+#include <algorithm>
+
+/* Declaration */
+namespace ds_imp {
+
+/*
+ * Suffix array built by SA-IS in O(n). The build needs the text plus 4n bytes for the array;
+ * the recursion keeps its reduced string and, when it fits, its buckets in the unused part of
+ * the array, so only n / 8 bytes of type bits per level come on top. build_lcp() is extra: it
+ * needs 8n more bytes at its peak, the rank array and the LCP array, and keeps the 4n of the LCP.
+ */
+class Suffix_Array {
+
+    public:
+        Suffix_Array(std::string_view text);
+        Suffix_Array(Mapped_File &&file);
+        ~Suffix_Array();
+
+        void build_lcp();
+        std::pair<size_t, size_t> equal_range(std::string_view pattern) const;
+        size_t count(std::string_view pattern) const;
+        bool contains(std::string_view pattern) const;
+        std::vector<size_t> locate(std::string_view pattern) const;
+        inline size_t operator[](size_t i) const;
+        inline size_t lcp(size_t i) const;
+        void show(std::ostream &os) const;
+        inline bool empty() const;
+        inline size_t size() const;
+
+        static constexpr size_t MAX_LENGTH = INT32_MAX - 1;
+
+    private:
+        std::optional<Mapped_File> source;  // holds the mapping when the text comes from a file
+        std::string_view text;
+        std::vector<int32_t> sa;
+        std::vector<int32_t> lcp_array;   // lcp_array[i] = LCP of the suffixes sa[i - 1] and sa[i], empty until build_lcp()
+
+        void build();
+        template <bool Upper>
+        size_t bound(std::string_view pattern) const;
+};
+
+template <typename C>
+void sa_is(const C* s, int32_t* sa, int32_t n, int32_t k, int32_t* scratch, int32_t scratch_size);
+
+}
+
+/* Implementation */
+namespace ds_imp {
+
+/* SA-IS */
+template <typename C>
+void sa_is(const C* s, int32_t* sa, int32_t n, int32_t k, int32_t* scratch, int32_t scratch_size) {
+
+    // s[0 .. n) over the alphabet [0, k), with a virtual sentinel after s[n - 1] smaller than every character
+    if(n == 0)
+        return;
+    if(n == 1) {
+        sa[0] = 0;
+        return;
+    }
+
+    // S-type bits: s[i] < s[i + 1], or equal and i + 1 is S-type; s[n - 1] is L-type before the sentinel
+    std::vector<uint64_t> types((static_cast<size_t>(n) + 63) / 64, 0);
+    auto is_s = [&](int32_t i) { return ((types[i >> 6] >> (i & 63)) & 1) != 0; };
+    auto is_lms = [&](int32_t i) { return i > 0 && i < n && is_s(i) && !is_s(i - 1); };
+
+    for(int32_t i = n - 2; i >= 0; --i) {
+        bool s_type = (s[i] < s[i + 1]) || (s[i] == s[i + 1] && is_s(i + 1));
+        if(s_type) types[i >> 6] |= (static_cast<uint64_t>(1) << (i & 63));
+    }
+
+    // the buckets live in the caller's spare space when they fit
+    std::vector<int32_t> own;
+    int32_t *bucket = scratch;
+    if(k > scratch_size) {
+        own.resize(k);
+        bucket = own.data();
+    }
+
+    auto fill_buckets = [&](bool end) {
+        std::fill(bucket, bucket + k, 0);
+        for(int32_t i = 0; i < n; ++i)
+            bucket[s[i]] ++;
+
+        int32_t sum = 0;
+        for(int32_t c = 0; c < k; ++c) {
+            sum += bucket[c];
+            bucket[c] = (end) ? (sum) : (sum - bucket[c]);
+        }
+    };
+
+    auto induce = [&]() {
+        // L-types left to right from bucket heads; the sentinel puts n - 1 first
+        fill_buckets(false);
+        sa[bucket[s[n - 1]] ++] = n - 1;
+        for(int32_t i = 0; i < n; ++i) {
+            int32_t j = sa[i] - 1;
+            if(sa[i] > 0 && !is_s(j)) sa[bucket[s[j]] ++] = j;
+        }
+
+        // S-types right to left from bucket tails
+        fill_buckets(true);
+        for(int32_t i = n - 1; i >= 0; --i) {
+            int32_t j = sa[i] - 1;
+            if(sa[i] > 0 && is_s(j)) sa[-- bucket[s[j]]] = j;
+        }
+    };
+
+    // 1. sort the LMS substrings by one induced pass from unsorted LMS positions
+    std::fill(sa, sa + n, -1);
+    fill_buckets(true);
+    for(int32_t i = 1; i < n; ++i)
+        if(is_lms(i)) sa[-- bucket[s[i]]] = i;
+    induce();
+
+    // 2. pack the sorted LMS positions to the front and name each distinct LMS substring
+    int32_t n1 = 0;
+    for(int32_t i = 0; i < n; ++i)
+        if(is_lms(sa[i])) sa[n1 ++] = sa[i];
+
+    std::fill(sa + n1, sa + n, -1);
+    int32_t name = 0, prev = -1;
+    for(int32_t i = 0; i < n1; ++i) {
+        int32_t pos = sa[i];
+        bool diff = (prev < 0);
+
+        for(int32_t d = 0; !diff; ++d) {
+            if(pos + d == n || prev + d == n || s[pos + d] != s[prev + d] || is_s(pos + d) != is_s(prev + d)) {
+                diff = true;
+            }
+            else if(d > 0 && (is_lms(pos + d) || is_lms(prev + d))) {
+                break;
+            }
+        }
+
+        if(diff) {
+            name ++;
+            prev = pos;
+        }
+        sa[n1 + pos / 2] = name - 1;  // LMS positions are at least two apart
+    }
+
+    // 3. the reduced string, in text order, goes to the end of sa
+    int32_t *s1 = sa + n - n1;
+    for(int32_t i = n - 1, j = n - 1; i >= n1; --i)
+        if(sa[i] >= 0) sa[j --] = sa[i];
+
+    // 4. sort the reduced suffixes, recursing only while some names repeat
+    if(name < n1) {
+        sa_is<int32_t>(s1, sa, n1, name, sa + n1, n - 2 * n1);
+    }
+    else {
+        for(int32_t i = 0; i < n1; ++i)
+            sa[s1[i]] = i;
+    }
+
+    // 5. the sorted LMS suffixes seed the final induced pass
+    for(int32_t i = 1, j = 0; i < n; ++i)
+        if(is_lms(i)) s1[j ++] = i;
+    for(int32_t i = 0; i < n1; ++i)
+        sa[i] = s1[sa[i]];
+    std::fill(sa + n1, sa + n, -1);
+
+    fill_buckets(true);
+    for(int32_t i = n1 - 1; i >= 0; --i) {
+        int32_t j = sa[i];
+        sa[i] = -1;
+        sa[-- bucket[s[j]]] = j;
+    }
+    induce();
+}
+
+/* Suffix_Array */
+inline Suffix_Array::Suffix_Array(std::string_view text) : text(text) {
+    build();
+}
+
+inline Suffix_Array::Suffix_Array(Mapped_File &&file) {
+
+    source.emplace(std::move(file));
+    text = source->view();
+    build();
+}
+
+inline Suffix_Array::~Suffix_Array() = default;
+
+inline void Suffix_Array::build() {
+
+    if(text.size() > MAX_LENGTH) {
+        throw std::length_error("The text is too long for the Suffix_Array");
+    }
+
+    int32_t n = static_cast<int32_t>(text.size());
+    sa.resize(n);
+    sa_is<uint8_t>(reinterpret_cast<const uint8_t*>(text.data()), sa.data(), n, 256, nullptr, 0);
+}
+
+inline void Suffix_Array::build_lcp() {
+
+    // Kasai: walking suffixes in text order, the LCP with the previous suffix drops by at most one each step
+    size_t n = sa.size();
+    std::vector<int32_t> rank(n);
+    for(size_t i = 0; i < n; ++i)
+        rank[sa[i]] = static_cast<int32_t>(i);
+
+    lcp_array.assign(n, 0);
+    for(size_t i = 0, h = 0; i < n; ++i) {
+        if(rank[i] == 0) {
+            h = 0;
+            continue;
+        }
+
+        size_t j = sa[rank[i] - 1];
+        while(i + h < n && j + h < n && text[i + h] == text[j + h])
+            h ++;
+        lcp_array[rank[i]] = static_cast<int32_t>(h);
+        if(h > 0) h --;
+    }
+}
+
+inline std::pair<size_t, size_t> Suffix_Array::equal_range(std::string_view pattern) const {
+    // the rows of sa whose suffixes start with pattern
+    return {bound<false>(pattern), bound<true>(pattern)};
+}
+
+inline size_t Suffix_Array::count(std::string_view pattern) const {
+
+    auto [first, last] = equal_range(pattern);
+    return last - first;
+}
+
+inline bool Suffix_Array::contains(std::string_view pattern) const {
+    return count(pattern) > 0;
+}
+
+inline std::vector<size_t> Suffix_Array::locate(std::string_view pattern) const {
+
+    // the text positions of every occurrence, in increasing order
+    auto [first, last] = equal_range(pattern);
+    std::vector<size_t> positions(sa.begin() + first, sa.begin() + last);
+    std::sort(positions.begin(), positions.end());
+    return positions;
+}
+
+inline size_t Suffix_Array::operator[](size_t i) const {
+    return sa[i];
+}
+
+inline size_t Suffix_Array::lcp(size_t i) const {
+    return lcp_array[i];
+}
+
+inline void Suffix_Array::show(std::ostream &os) const {
+
+    os << "Size: " << std::setw(4) << size() << std::endl;
+    for(size_t i = 0; i < sa.size(); ++i) {
+        os << std::setw(4) << sa[i] << ": ";
+        if(!lcp_array.empty()) os << std::setw(4) << lcp_array[i] << " ";
+        os << text.substr(sa[i], 32) << std::endl;
+    }
+}
+
+inline bool Suffix_Array::empty() const {
+    return (size() == 0);
+}
+
+inline size_t Suffix_Array::size() const {
+    return sa.size();
+}
+
+template <bool Upper>
+size_t Suffix_Array::bound(std::string_view pattern) const {
+
+    // binary search where every suffix between the bounds shares min(lcp_left, lcp_right)
+    // characters with pattern, so each comparison starts there instead of at zero. The worst
+    // case stays O(m log n); O(m + log n) would need the LCPs of every search interval's ends,
+    // 8n more bytes, so lcp_array is not used here
+    size_t left = 0, right = sa.size(), lcp_left = 0, lcp_right = 0, m = pattern.size();
+
+    while(left < right) {
+        size_t mid = left + (right - left) / 2, pos = sa[mid];
+        size_t k = std::min(lcp_left, lcp_right);
+        while(k < m && pos + k < text.size() && text[pos + k] == pattern[k])
+            k ++;
+
+        // the suffix goes left of the bound when it sorts below pattern,
+        // and for the upper bound also when pattern is its prefix
+        bool go_right = (k == m) ? (Upper) : (pos + k == text.size() || static_cast<uint8_t>(text[pos + k]) < static_cast<uint8_t>(pattern[k]));
+        if(go_right) {
+            left = mid + 1;
+            lcp_left = k;
+        }
+        else {
+            right = mid;
+            lcp_right = k;
+        }
+    }
+    return left;
+}
+
+}
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <utility>
+#include <future>
+#include <thread>
+
 template <typename T>
 T* double_arr(T* arr, size_t old_size) {
     
@@ -12,4 +17,28 @@ T* double_arr(T* arr, size_t old_size) {
 
     delete [] arr;
     return new_arr;
-}
\ No newline at end of file
+}
+
+/* The recursion levels that still fork, so that at most about hardware_concurrency() threads run */
+inline size_t fork_depth() {
+
+    size_t depth = 0, threads = std::thread::hardware_concurrency();
+    while((static_cast<size_t>(1) << depth) < threads)
+        depth ++;
+    return depth;
+}
+
+/* Run func_a and func_b, func_a on another thread while depth > 0 */
+template <typename FuncA, typename FuncB>
+void fork_join(size_t depth, FuncA &&func_a, FuncB &&func_b) {
+
+    if(depth == 0) {
+        func_a();
+        func_b();
+        return;
+    }
+
+    auto handle = std::async(std::launch::async, std::forward<FuncA>(func_a));
+    func_b();
+    handle.get();
+}